@@ -0,0 +1,211 @@
+/** 
+ * Author: Jakub Lůčný (xlucnyj00)
+ * Date: 18.10.2026
+ * 
+ * VUT FIT IMP 2025
+ */
+
+#include <ctype.h>
+#include <errno.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "nvs_flash.h"
+#include "nvs.h"
+#include "esp_mac.h"
+#include "esp_log.h"
+#include "app_config.h"
+
+#define TAG "AppConfig"
+#define NVS_NAMESPACE "app"
+
+// Thresholds are stored in NVS as thousandths
+#define MILLI 1000.0f
+// Largest accepted rate threshold (change per minute)
+#define RATE_MAX 1000.0f
+
+// NVS/bundle key of the base topic template and the key of the former full publish topic
+#define KEY_TOPIC_BASE      "topic_base"
+#define KEY_TOPIC_LEGACY    "topic"
+
+app_config_t g_app_config;
+
+static void app_config_defaults(app_config_t *cfg) {
+    const sampler_limits_t limits = SAMPLER_LIMITS_DEFAULT;
+    memset(cfg, 0, sizeof(*cfg));
+    strncpy(cfg->broker_uri, CONFIG_MQTT_BROKER_URI, sizeof(cfg->broker_uri) - 1);
+    strncpy(cfg->topic, CONFIG_MQTT_TOPIC, sizeof(cfg->topic) - 1);
+    cfg->sampler = limits;
+}
+
+static void load_u32(nvs_handle_t nvh, const char *key, uint32_t *out) {
+    uint32_t v;
+    if (nvs_get_u32(nvh, key, &v) == ESP_OK) *out = v;
+}
+
+// Base topic from template of older firmware, which was used as the publish topic itself
+static esp_err_t topic_from_legacy(char *dst, size_t dst_len, const char *value) {
+    int n;
+    if (strstr(value, APP_CONFIG_ID_PLACEHOLDER)) {
+        n = snprintf(dst, dst_len, "%s", value);
+    }
+    else {
+        n = snprintf(dst, dst_len, "%s/" APP_CONFIG_ID_PLACEHOLDER, value);
+    }
+    return (n < 0 || (size_t)n >= dst_len) ? ESP_ERR_INVALID_SIZE : ESP_OK;
+}
+
+static void load_milli(nvs_handle_t nvh, const char *key, float *out) {
+    uint32_t v;
+    if (nvs_get_u32(nvh, key, &v) == ESP_OK) *out = (float)v / MILLI;
+}
+
+// Load defaults overridden by values stored in NVS
+void app_config_load(void) {
+    app_config_t *cfg = &g_app_config;
+    app_config_defaults(cfg);
+
+    nvs_handle_t nvh;
+    if (nvs_open(NVS_NAMESPACE, NVS_READONLY, &nvh) != ESP_OK) {
+        return;
+    }
+
+    size_t len = sizeof(cfg->broker_uri);
+    if (nvs_get_str(nvh, "broker", cfg->broker_uri, &len) != ESP_OK) {
+        strncpy(cfg->broker_uri, CONFIG_MQTT_BROKER_URI, sizeof(cfg->broker_uri) - 1);
+    }
+    len = sizeof(cfg->topic);
+    if (nvs_get_str(nvh, KEY_TOPIC_BASE, cfg->topic, &len) != ESP_OK) {
+        // Migrate topic stored by older firmware; written as topic_base on next save
+        char legacy[sizeof(cfg->topic)];
+        len = sizeof(legacy);
+        if (nvs_get_str(nvh, KEY_TOPIC_LEGACY, legacy, &len) != ESP_OK ||
+            topic_from_legacy(cfg->topic, sizeof(cfg->topic), legacy) != ESP_OK) {
+            strncpy(cfg->topic, CONFIG_MQTT_TOPIC, sizeof(cfg->topic) - 1);
+        }
+        else {
+            ESP_LOGI(TAG, "Stored topic %s migrated to base topic %s", legacy, cfg->topic);
+        }
+    }
+    load_u32(nvh, "smp_min", &cfg->sampler.min_ms);
+    load_u32(nvh, "smp_max", &cfg->sampler.max_ms);
+    load_milli(nvh, "rate_t", &cfg->sampler.rate_t);
+    load_milli(nvh, "rate_h", &cfg->sampler.rate_h);
+    load_u32(nvh, "backlog", &cfg->sampler.backlog_high);
+    nvs_close(nvh);
+
+    ESP_LOGI(TAG, "broker=%s topic=%s interval=%lu..%lums",
+            cfg->broker_uri, cfg->topic,
+            (unsigned long)cfg->sampler.min_ms, (unsigned long)cfg->sampler.max_ms);
+}
+
+// Store configuration in NVS; takes effect after restart
+esp_err_t app_config_save(const app_config_t *cfg) {
+    nvs_handle_t nvh;
+    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvh);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    if (err == ESP_OK) err = nvs_set_str(nvh, "broker", cfg->broker_uri);
+    if (err == ESP_OK) err = nvs_set_str(nvh, KEY_TOPIC_BASE, cfg->topic);
+    if (err == ESP_OK) {
+        err = nvs_erase_key(nvh, KEY_TOPIC_LEGACY);
+        if (err == ESP_ERR_NVS_NOT_FOUND) err = ESP_OK;
+    }
+    if (err == ESP_OK) err = nvs_set_u32(nvh, "smp_min", cfg->sampler.min_ms);
+    if (err == ESP_OK) err = nvs_set_u32(nvh, "smp_max", cfg->sampler.max_ms);
+    if (err == ESP_OK) err = nvs_set_u32(nvh, "rate_t", (uint32_t)(cfg->sampler.rate_t * MILLI));
+    if (err == ESP_OK) err = nvs_set_u32(nvh, "rate_h", (uint32_t)(cfg->sampler.rate_h * MILLI));
+    if (err == ESP_OK) err = nvs_set_u32(nvh, "backlog", cfg->sampler.backlog_high);
+    if (err == ESP_OK) err = nvs_commit(nvh);
+    nvs_close(nvh);
+    return err;
+}
+
+// Parse decimal number not lower than min; sign and out-of-range values are rejected
+static esp_err_t parse_u32(const char *value, uint32_t min, uint32_t *out) {
+    char *end;
+    while (isspace((unsigned char)*value)) value++;
+    if (*value == '-' || *value == '+') return ESP_ERR_INVALID_ARG;
+    errno = 0;
+    unsigned long v = strtoul(value, &end, 10);
+    if (end == value || *end != '\0' || errno == ERANGE || v > UINT32_MAX || v < min) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *out = (uint32_t)v;
+    return ESP_OK;
+}
+
+// Parse rate threshold; stored in NVS as thousandths, so it must fit u32 after scaling
+static esp_err_t parse_float(const char *value, float *out) {
+    char *end;
+    float v = strtof(value, &end);
+    if (end == value || *end != '\0' || !isfinite(v) || v < 0.0f || v > RATE_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *out = v;
+    return ESP_OK;
+}
+
+static esp_err_t copy_str(char *dst, size_t dst_len, const char *value) {
+    if (strlen(value) >= dst_len) return ESP_ERR_INVALID_SIZE;
+    strcpy(dst, value);
+    return ESP_OK;
+}
+
+// Set single configuration key from its text value
+esp_err_t app_config_set(app_config_t *cfg, const char *key, const char *value) {
+    if (strcmp(key, "broker") == 0)        return copy_str(cfg->broker_uri, sizeof(cfg->broker_uri), value);
+    if (strcmp(key, KEY_TOPIC_BASE) == 0) {
+        if (!strstr(value, APP_CONFIG_ID_PLACEHOLDER)) return ESP_ERR_INVALID_ARG;
+        return copy_str(cfg->topic, sizeof(cfg->topic), value);
+    }
+    if (strcmp(key, KEY_TOPIC_LEGACY) == 0) return topic_from_legacy(cfg->topic, sizeof(cfg->topic), value);
+    if (strcmp(key, "sample_min_ms") == 0) return parse_u32(value, 1, &cfg->sampler.min_ms);
+    if (strcmp(key, "sample_max_ms") == 0) return parse_u32(value, 1, &cfg->sampler.max_ms);
+    if (strcmp(key, "rate_t") == 0)        return parse_float(value, &cfg->sampler.rate_t);
+    if (strcmp(key, "rate_h") == 0)        return parse_float(value, &cfg->sampler.rate_h);
+    if (strcmp(key, "backlog") == 0)       return parse_u32(value, 1, &cfg->sampler.backlog_high);
+    return ESP_ERR_NOT_FOUND;
+}
+
+// Check relations between values which app_config_set cannot see one key at a time
+esp_err_t app_config_check(const app_config_t *cfg) {
+    if (cfg->sampler.min_ms > cfg->sampler.max_ms) return ESP_ERR_INVALID_ARG;
+    return ESP_OK;
+}
+
+// Device id derived from the station MAC address
+const char *app_config_device_id(void) {
+    static char id[13];
+    if (id[0] == '\0') {
+        uint8_t mac[6];
+        esp_read_mac(mac, ESP_MAC_WIFI_STA);
+        snprintf(id, sizeof(id), "%02x%02x%02x%02x%02x%02x",
+                mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+    }
+    return id;
+}
+
+// Expand topic template, every {id} is replaced by device id
+void app_config_topic(char *out, size_t out_len) {
+    const char *src = g_app_config.topic;
+    const char *id = app_config_device_id();
+    const size_t ph_len = strlen(APP_CONFIG_ID_PLACEHOLDER);
+    size_t n = 0;
+
+    while (*src && n + 1 < out_len) {
+        if (strncmp(src, APP_CONFIG_ID_PLACEHOLDER, ph_len) == 0) {
+            n += snprintf(out + n, out_len - n, "%s", id);
+            if (n >= out_len) n = out_len - 1;
+            src += ph_len;
+        }
+        else {
+            out[n++] = *src++;
+        }
+    }
+    out[n] = '\0';
+}
@@ -0,0 +1,54 @@
+/** 
+ * Author: Jakub Lůčný (xlucnyj00)
+ * Date: 18.10.2026
+ * 
+ * VUT FIT IMP 2025
+ */
+
+#ifndef APP_CONFIG_H
+#define APP_CONFIG_H
+
+#include <stddef.h>
+#include "esp_err.h"
+#include "sampler.h"
+
+// Placeholder in topic template replaced by device id
+#define APP_CONFIG_ID_PLACEHOLDER "{id}"
+
+// Defaults used until a value is stored in NVS
+#ifndef CONFIG_MQTT_BROKER_URI
+#define CONFIG_MQTT_BROKER_URI "mqtt://broker.hivemq.com:1883"
+#endif
+// Base topic template; must contain {id} so every unit gets its own retained topics
+#ifndef CONFIG_MQTT_TOPIC
+#define CONFIG_MQTT_TOPIC "meteostanice/" APP_CONFIG_ID_PLACEHOLDER
+#endif
+
+// Runtime configuration stored in NVS namespace "app"
+typedef struct {
+    char broker_uri[128];
+    char topic[96];             /*!< Base topic template containing {id} */
+    sampler_limits_t sampler;
+} app_config_t;
+
+// Active configuration, filled by app_config_load
+extern app_config_t g_app_config;
+
+// Load defaults overridden by values stored in NVS
+void app_config_load(void);
+// Store configuration in NVS; takes effect after restart
+esp_err_t app_config_save(const app_config_t *cfg);
+/* Set single configuration key from its text value (as used in config bundles).
+    topic_base must contain {id}. Legacy key topic (full publish topic of older firmware,
+    shared by all units) is migrated to a base topic by appending "/{id}" when missing.
+    Intervals and backlog must be at least 1, rate_t and rate_h within 0..1000.
+*/
+esp_err_t app_config_set(app_config_t *cfg, const char *key, const char *value);
+// Check the whole configuration (sample_min_ms <= sample_max_ms) before it is saved
+esp_err_t app_config_check(const app_config_t *cfg);
+// Device id derived from the station MAC address (12 hex digits)
+const char *app_config_device_id(void);
+// Expand topic template with device id
+void app_config_topic(char *out, size_t out_len);
+
+#endif // APP_CONFIG_H
@@ -0,0 +1,139 @@
+/** 
+ * Author: Jakub Lůčný (xlucnyj00)
+ * Date: 18.10.2026
+ * 
+ * VUT FIT IMP 2025
+ */
+
+#include <stdbool.h>
+#include <string.h>
+#include "esp_log.h"
+#include "mbedtls/md.h"
+#include "bundle.h"
+#include "app_config.h"
+#include "wifi.h"
+
+#define TAG "Bundle"
+
+#define SIG_PREFIX "sig="
+#define SIG_LEN    32
+
+static int hex_val(int c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+static esp_err_t copy_value(char *dst, size_t dst_len, const char *value) {
+    if (strlen(value) >= dst_len) return ESP_ERR_INVALID_SIZE;
+    strcpy(dst, value);
+    return ESP_OK;
+}
+
+// Find last line starting with "sig="
+static char *find_sig_line(char *data) {
+    char *sig = NULL;
+    for (char *p = data; *p; p++) {
+        if ((p == data || p[-1] == '\n') && strncmp(p, SIG_PREFIX, strlen(SIG_PREFIX)) == 0) {
+            sig = p;
+        }
+    }
+    return sig;
+}
+
+// Decode hex signature and compare it with expected one in constant time
+static bool sig_matches(const char *hex, const unsigned char *expected) {
+    unsigned char diff = 0;
+    for (int i = 0; i < SIG_LEN; i++) {
+        int hi = hex_val(hex[2 * i]);
+        int lo = (hi < 0) ? -1 : hex_val(hex[2 * i + 1]);
+        if (hi < 0 || lo < 0) return false;
+        diff |= (unsigned char)((hi << 4) | lo) ^ expected[i];
+    }
+    const char *rest = hex + 2 * SIG_LEN;
+    while (*rest == '\r' || *rest == '\n' || *rest == ' ') rest++;
+    return diff == 0 && *rest == '\0';
+}
+
+// Verify bundle signature and store its content in NVS
+esp_err_t bundle_apply(char *data, size_t len) {
+    const char *key = CONFIG_BUNDLE_KEY;
+    if (key[0] == '\0') {
+        ESP_LOGW(TAG, "Bundle key not configured");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    data[len] = '\0';
+    char *sig = find_sig_line(data);
+    if (!sig) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    unsigned char mac[SIG_LEN];
+    const mbedtls_md_info_t *md = mbedtls_md_info_from_type(MBEDTLS_MD_SHA256);
+    if (mbedtls_md_hmac(md, (const unsigned char *)key, strlen(key),
+                        (const unsigned char *)data, sig - data, mac) != 0) {
+        return ESP_ERR_NO_MEM;
+    }
+    if (!sig_matches(sig + strlen(SIG_PREFIX), mac)) {
+        ESP_LOGW(TAG, "Bundle signature mismatch");
+        return ESP_ERR_INVALID_CRC;
+    }
+    *sig = '\0';
+
+    // Parse signed part line by line into copies; nothing is stored unless all lines are valid
+    app_config_t cfg = g_app_config;
+    char ssid[64] = {0}, pass[64] = {0};
+    char *save = NULL;
+    for (char *line = strtok_r(data, "\n", &save); line; line = strtok_r(NULL, "\n", &save)) {
+        size_t n = strlen(line);
+        if (n > 0 && line[n - 1] == '\r') line[--n] = '\0';
+        if (n == 0 || line[0] == '#') continue;
+
+        char *eq = strchr(line, '=');
+        if (!eq) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        *eq = '\0';
+        const char *value = eq + 1;
+
+        esp_err_t err;
+        if (strcmp(line, "ssid") == 0) {
+            err = copy_value(ssid, sizeof(ssid), value);
+        }
+        else if (strcmp(line, "pass") == 0) {
+            err = copy_value(pass, sizeof(pass), value);
+        }
+        else {
+            err = app_config_set(&cfg, line, value);
+        }
+        if (err != ESP_OK) {
+            ESP_LOGW(TAG, "Invalid bundle entry %s", line);
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+
+    if (app_config_check(&cfg) != ESP_OK) {
+        ESP_LOGW(TAG, "Inconsistent bundle configuration");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // Configuration first; if credentials then fail, the previous configuration is restored
+    esp_err_t err = app_config_save(&cfg);
+    if (err != ESP_OK) {
+        return err;
+    }
+    if (ssid[0] != '\0') {
+        err = wifi_save_creds(ssid, pass);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Storing Wi-Fi credentials failed: %s", esp_err_to_name(err));
+            esp_err_t restore = app_config_save(&g_app_config);
+            if (restore != ESP_OK) {
+                ESP_LOGE(TAG, "Restoring previous configuration failed: %s", esp_err_to_name(restore));
+                return ESP_FAIL;
+            }
+        }
+    }
+    return err;
+}
@@ -0,0 +1,43 @@
+/** 
+ * Author: Jakub Lůčný (xlucnyj00)
+ * Date: 18.10.2026
+ * 
+ * VUT FIT IMP 2025
+ */
+
+#ifndef BUNDLE_H
+#define BUNDLE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+/* Config bundle: text with one key=value per line, '#' starts a comment
+    ssid, pass      - Wi-Fi credentials
+    other keys      - see app_config_set
+    sig=<hex>       - last line, HMAC-SHA256 of all preceding bytes keyed by CONFIG_BUNDLE_KEY
+   Bundles are produced by tools/provision.py.
+*/
+
+// Pre-shared bundle signing key; bundles are refused while it is empty
+#ifndef CONFIG_BUNDLE_KEY
+#define CONFIG_BUNDLE_KEY ""
+#endif
+
+// Largest accepted bundle
+#define BUNDLE_MAX_LEN 1024
+
+// Bundle body collected before its signature can be verified
+typedef struct {
+    char data[BUNDLE_MAX_LEN + 1];
+    size_t len;
+    bool overflow;
+} bundle_buf_t;
+
+// Verify bundle signature and store its Wi-Fi credentials and configuration in NVS;
+// data must have room for terminating zero at data[len]. Returns ESP_ERR_INVALID_ARG for
+// invalid content, NVS error when storing failed (previous configuration is kept) and
+// ESP_FAIL when the new configuration stayed stored without its Wi-Fi credentials
+esp_err_t bundle_apply(char *data, size_t len);
+
+#endif // BUNDLE_H
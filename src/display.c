@@ -14,43 +14,145 @@
  * VUT FIT IMP 2025
  */
 
+#include <string.h>
 #include "freertos/FreeRTOS.h"
 #include "esp_log.h"
 #include "display.h"
 #include "i2c_bus.h"
 
-// I2C device handle for the OLED display
-static i2c_master_dev_handle_t display_dev_handle  = NULL;
+// u8g2 setup function matching the selected buffer mode
+#if CONFIG_DISPLAY_BUFFER_MODE == DISPLAY_BUFFER_FULL
+#define DISPLAY_SETUP u8g2_Setup_ssd1306_i2c_128x64_noname_f
+#elif CONFIG_DISPLAY_BUFFER_MODE == DISPLAY_BUFFER_TWO_PAGE
+#define DISPLAY_SETUP u8g2_Setup_ssd1306_i2c_128x64_noname_2
+#elif CONFIG_DISPLAY_BUFFER_MODE == DISPLAY_BUFFER_ONE_PAGE
+#define DISPLAY_SETUP u8g2_Setup_ssd1306_i2c_128x64_noname_1
+#else
+#error "Unsupported CONFIG_DISPLAY_BUFFER_MODE"
+#endif
+
+/* Pending u8x8 transfer: up to XFER_SEGS_MAX segments sent as one I2C transaction
+    by i2c_master_multi_buffer_transmit. A tile row (control byte and 128 data bytes from
+    u8x8_cad_ssd1306_row_i2c) fits into one transaction; longer transfers are split at
+    CONFIG_DISPLAY_I2C_CHUNK_MAX, each chunk repeating the SSD1306 control byte
+    (0x00 command, 0x40 data) so GDDRAM writes simply continue where the previous ended.
+*/
+#define XFER_SEGS_MAX       8
+#define XFER_STAGE_LEN      32
+#define XFER_ZERO_COPY_MIN  8
+
+typedef struct {
+    i2c_master_transmit_multi_buffer_info_t seg[XFER_SEGS_MAX];
+    uint8_t stage[XFER_STAGE_LEN];  /*!< Copies of short segments */
+    size_t nseg;
+    size_t stage_len;
+    size_t total;                   /*!< Bytes in the current chunk */
+    uint8_t control;                /*!< First byte of the transfer */
+    bool continued;                 /*!< Transfer was split, control byte is repeated */
+    bool failed;
+} xfer_t;
+
+static xfer_t s_xfer;
+// Display answered its probe; otherwise transfers are dropped instead of timing out
+static bool s_present;
+
+_Static_assert(sizeof(xfer_t) <= DISPLAY_XFER_BYTES, "Update DISPLAY_XFER_BYTES in display.h");
+
+// Context for status screen
+typedef struct {
+    const char *line1;
+    const char *line2;
+} status_ctx_t;
+
+// Context for screen with progress bar overlay
+typedef struct {
+    display_draw_fn draw;
+    const void *ctx;
+    int fill_width;
+} progress_ctx_t;
+
+// Send pending segments as one transaction
+static void xfer_flush(void) {
+    xfer_t *x = &s_xfer;
+
+    if (x->nseg > 0 && s_present && i2c_bus_transmit_multi(I2C_DEV_DISPLAY, x->seg, x->nseg) != ESP_OK) {
+        x->failed = true;
+    }
+    x->nseg = 0;
+    x->stage_len = 0;
+    x->total = 0;
+}
+
+// Append bytes to the pending transfer; large segments are referenced in place,
+// small ones are copied because u8x8 passes single bytes from its stack
+static void xfer_add(const uint8_t *data, size_t len) {
+    xfer_t *x = &s_xfer;
+
+    while (len > 0) {
+        size_t stage_free = XFER_STAGE_LEN - x->stage_len;
+        bool copy = len < XFER_ZERO_COPY_MIN;
+
+        if (x->total == CONFIG_DISPLAY_I2C_CHUNK_MAX || x->nseg == XFER_SEGS_MAX || (copy && stage_free == 0)) {
+            // Split into a new transaction which starts with the same control byte
+            uint8_t control = x->control;
+            xfer_flush();
+            x->continued = true;
+            xfer_add(&control, 1);
+            continue;
+        }
+        if (x->total == 0 && !x->continued) {
+            x->control = data[0];
+        }
+
+        size_t n = len < CONFIG_DISPLAY_I2C_CHUNK_MAX - x->total ? len : CONFIG_DISPLAY_I2C_CHUNK_MAX - x->total;
+        i2c_master_transmit_multi_buffer_info_t *last = x->nseg ? &x->seg[x->nseg - 1] : NULL;
+        if (copy) {
+            n = n < stage_free ? n : stage_free;
+            uint8_t *dst = &x->stage[x->stage_len];
+            memcpy(dst, data, n);
+            x->stage_len += n;
+            if (last && last->write_buffer + last->buffer_size == dst) {
+                last->buffer_size += n;
+            }
+            else {
+                x->seg[x->nseg++] = (i2c_master_transmit_multi_buffer_info_t){ dst, n };
+            }
+        }
+        else {
+            // Points into the u8g2 buffer which stays untouched until the transfer ends
+            x->seg[x->nseg++] = (i2c_master_transmit_multi_buffer_info_t){ (uint8_t *)data, n };
+        }
+        x->total += n;
+        data += n;
+        len -= n;
+    }
+}
+
+static void xfer_start(void) {
+    xfer_flush();
+    s_xfer.continued = false;
+    s_xfer.failed = false;
+}
 
 // Handles all I2C communication between U8G2 library and display controller
 // Returns 1 on success, 0 on failure
 static uint8_t u8x8_byte_i2c_cb(u8x8_t *u8x8, uint8_t msg, uint8_t arg_int, void *arg_ptr) {
-    static uint8_t buffer[132];  /*!< Enhanced buffer: control byte + 128 data bytes + margin */
-    static uint8_t buf_idx;      /*!< Current buffer index */
-
     switch(msg) {
         case U8X8_MSG_BYTE_INIT:
-            buf_idx = 0;
-            break;
         case U8X8_MSG_BYTE_START_TRANSFER:
-            buf_idx = 0;
+            xfer_start();
             break;
         case U8X8_MSG_BYTE_SET_DC:
             /* DC (Data/Command) control - handled by SSD1306 protocol */
             break;
         case U8X8_MSG_BYTE_SEND:
-            /* Add data bytes to buffer */
-            for (size_t i = 0; i < arg_int; ++i) {
-                buffer[buf_idx++] = *((uint8_t*)arg_ptr + i);
-            }
+            xfer_add(arg_ptr, arg_int);
             break;
         case U8X8_MSG_BYTE_END_TRANSFER:
-            if (buf_idx > 0 && display_dev_handle != NULL) {
-                esp_err_t ret = i2c_master_transmit(display_dev_handle, buffer, buf_idx, I2C_TIMEOUT_MS);
-                if (ret != ESP_OK) {
-                    ESP_LOGE("Display", "I2C master transmission failed");
-                    return 0;
-                }
+            xfer_flush();
+            if (s_xfer.failed) {
+                ESP_LOGE("Display", "I2C master transmission failed");
+                return 0;
             }
             break;
         default:
@@ -82,7 +184,8 @@ static uint8_t u8g2_esp32_gpio_delay_cb(u8x8_t *u8x8, uint8_t msg, uint8_t arg_i
         break;
 
     case U8X8_MSG_DELAY_I2C:
-        /* I2C timing delay: 5us for 100KHz, 1.25us for 400KHz */
+        /* Half clock period for software I2C (arg_int 1 = 100 kHz, 4 = 400 kHz);
+           unused here, the hardware controller times the bus at the negotiated clock */
         esp_rom_delay_us(5 / arg_int);
         break;
 
@@ -97,43 +200,128 @@ static uint8_t u8g2_esp32_gpio_delay_cb(u8x8_t *u8x8, uint8_t msg, uint8_t arg_i
     return 1;
 }
 
+/* Command/data layer for SSD1306 over I2C. Same as u8x8_cad_ssd13xx_fast_i2c except
+    that data is not cut into 24 byte transactions (a workaround for small AVR/ESP8266
+    I2C buffers): a whole tile row of 128 bytes goes to the byte layer as one transfer
+    and is sent as a single transaction with one address and one control byte.
+*/
+static uint8_t u8x8_cad_ssd1306_row_i2c(u8x8_t *u8x8, uint8_t msg, uint8_t arg_int, void *arg_ptr) {
+    static uint8_t in_transfer = 0;
+
+    switch (msg) {
+        case U8X8_MSG_CAD_SEND_CMD:
+            /* Commands are collected into one open transfer with control byte 0x00 */
+            if (!in_transfer) {
+                u8x8_byte_StartTransfer(u8x8);
+                u8x8_byte_SendByte(u8x8, 0x00);
+                in_transfer = 1;
+            }
+            u8x8_byte_SendByte(u8x8, arg_int);
+            break;
+        case U8X8_MSG_CAD_SEND_ARG:
+            u8x8_byte_SendByte(u8x8, arg_int);
+            break;
+        case U8X8_MSG_CAD_SEND_DATA:
+            if (in_transfer) {
+                u8x8_byte_EndTransfer(u8x8);
+            }
+            u8x8_byte_StartTransfer(u8x8);
+            u8x8_byte_SendByte(u8x8, 0x40);
+            u8x8_byte_SendBytes(u8x8, arg_int, arg_ptr);
+            u8x8_byte_EndTransfer(u8x8);
+            in_transfer = 0;
+            break;
+        case U8X8_MSG_CAD_INIT:
+            /* Default address so that start transfer can use it */
+            if (u8x8->i2c_address == 255) {
+                u8x8->i2c_address = 0x78;
+            }
+            return u8x8->byte_cb(u8x8, msg, arg_int, arg_ptr);
+        case U8X8_MSG_CAD_START_TRANSFER:
+            in_transfer = 0;
+            break;
+        case U8X8_MSG_CAD_END_TRANSFER:
+            if (in_transfer) {
+                u8x8_byte_EndTransfer(u8x8);
+            }
+            in_transfer = 0;
+            break;
+        default:
+            return 0;
+    }
+    return 1;
+}
+
+// Probe with SSD1306 NOP command; a missed ACK shows the clock is too fast, a passing
+// probe does not prove data integrity (see CONFIG_I2C_DISPLAY_FREQUENCY)
+static esp_err_t ssd1306_probe(i2c_dev_id_t dev) {
+    const uint8_t nop[2] = { 0x00, 0xE3 };
+    return i2c_bus_transmit(dev, nop, sizeof(nop));
+}
+
 // Initialize OLED display over I2C and wake it up
 void display_init(u8g2_t *u8g2, uint8_t i2c_addr) {
-    i2c_device_config_t oled_config = {
-        .dev_addr_length = I2C_ADDR_BIT_LEN_7,
-        .device_address = i2c_addr,
-        .scl_speed_hz = CONFIG_I2C_MASTER_FREQUENCY,
-        .flags.disable_ack_check = false,
-    };
-    i2c_master_bus_add_device(g_i2c_bus, &oled_config, &display_dev_handle);
-
-    u8g2_Setup_ssd1306_i2c_128x64_noname_f(
+    esp_err_t err = i2c_bus_add_device(I2C_DEV_DISPLAY, i2c_addr, CONFIG_I2C_DISPLAY_FREQUENCY, ssd1306_probe);
+    s_present = (err == ESP_OK);
+    if (!s_present) {
+        ESP_LOGE("Display", "OLED not responding (%s), output disabled", esp_err_to_name(err));
+    }
+
+    DISPLAY_SETUP(
         u8g2, U8G2_R0,
         u8x8_byte_i2c_cb,
         u8g2_esp32_gpio_delay_cb
     );
+    // Replace stock command/data layer so page rows are not split into 24 byte transfers
+    u8g2->u8x8.cad_cb = u8x8_cad_ssd1306_row_i2c;
 
     u8x8_SetI2CAddress(&u8g2->u8x8, i2c_addr << 1);
+    if (!s_present) {
+        return;
+    }
     u8g2_InitDisplay(u8g2);
     u8g2_SetPowerSave(u8g2, 0);
 }
 
-// Draw status text
-void display_draw_status(u8g2_t *u8g2, const char *line1, const char *line2) {
+// Render screen; full buffer is drawn and sent at once, page modes draw per page
+void display_render(u8g2_t *u8g2, display_draw_fn draw, const void *ctx) {
+#if CONFIG_DISPLAY_BUFFER_MODE == DISPLAY_BUFFER_FULL
     u8g2_ClearBuffer(u8g2);
-    u8g2_SetFont(u8g2, u8g2_font_6x10_tf);
-    if (line1) u8g2_DrawStr(u8g2, 2, 14, line1);
-    if (line2) u8g2_DrawStr(u8g2, 2, 28, line2);
+    draw(u8g2, ctx);
     u8g2_SendBuffer(u8g2);
+#else
+    u8g2_FirstPage(u8g2);
+    do {
+        draw(u8g2, ctx);
+    } while (u8g2_NextPage(u8g2));
+#endif
+}
+
+static void draw_status(u8g2_t *u8g2, const void *ctx) {
+    const status_ctx_t *st = ctx;
+    u8g2_SetFont(u8g2, u8g2_font_6x10_tf);
+    if (st->line1) u8g2_DrawStr(u8g2, 2, 14, st->line1);
+    if (st->line2) u8g2_DrawStr(u8g2, 2, 28, st->line2);
 }
 
-// Animate a simple progress bar
-void display_progress_bar(u8g2_t *u8g2) {
+// Draw status text
+void display_draw_status(u8g2_t *u8g2, const char *line1, const char *line2) {
+    status_ctx_t st = { line1, line2 };
+    display_render(u8g2, draw_status, &st);
+}
+
+static void draw_progress(u8g2_t *u8g2, const void *ctx) {
+    const progress_ctx_t *pc = ctx;
+    pc->draw(u8g2, pc->ctx);
     u8g2_DrawFrame(u8g2, 10, 60, 108, 4);
+    u8g2_DrawBox(u8g2, 11, 61, pc->fill_width, 2);
+}
+
+// Animate a simple progress bar; whole screen is redrawn so page modes work too
+void display_progress_bar(u8g2_t *u8g2, display_draw_fn draw, const void *ctx) {
     for (int progress = 0; progress <= 100; progress += 5) {
-        int fill_width = (progress * 106) / 100;
-        u8g2_DrawBox(u8g2, 11, 61, fill_width, 2);
-        u8g2_SendBuffer(u8g2);
+        progress_ctx_t pc = { draw, ctx, (progress * 106) / 100 };
+        display_render(u8g2, draw_progress, &pc);
         vTaskDelay(pdMS_TO_TICKS(75));
     }
 }
@@ -10,13 +10,43 @@
 
 #include "u8g2.h"
 
-#define I2C_TIMEOUT_MS    1000
+// Longest I2C transaction sent to the display: control byte and one 128 column page row
+#ifndef CONFIG_DISPLAY_I2C_CHUNK_MAX
+#define CONFIG_DISPLAY_I2C_CHUNK_MAX   (1 + 128)
+#endif
 
-// Initialize OLED display over I2C and wake it up
+// u8g2 frame buffer modes: full frame (1024 B) or 2/1 page strips (256/128 B)
+#define DISPLAY_BUFFER_FULL     0
+#define DISPLAY_BUFFER_ONE_PAGE 1
+#define DISPLAY_BUFFER_TWO_PAGE 2
+
+#ifndef CONFIG_DISPLAY_BUFFER_MODE
+#define CONFIG_DISPLAY_BUFFER_MODE DISPLAY_BUFFER_FULL
+#endif
+
+// Size of the statically allocated u8g2 buffer for the selected mode (128x64 panel)
+#if CONFIG_DISPLAY_BUFFER_MODE == DISPLAY_BUFFER_FULL
+#define DISPLAY_BUFFER_BYTES    1024
+#else
+#define DISPLAY_BUFFER_BYTES    (CONFIG_DISPLAY_BUFFER_MODE * 128)
+#endif
+
+// Upper bound of the I2C transfer state in display.c, checked there
+#define DISPLAY_XFER_BYTES      192
+
+// Static bytes of display.c: u8g2 buffer and I2C transfer state
+#define DISPLAY_STATIC_BYTES    (DISPLAY_BUFFER_BYTES + DISPLAY_XFER_BYTES)
+
+// Callback drawing one complete screen; called once per page in page modes
+typedef void (*display_draw_fn)(u8g2_t *u8g2, const void *ctx);
+
+// Initialize OLED display over I2C and wake it up; when it does not answer, drawing is a no-op
 void display_init(u8g2_t *u8g2, uint8_t i2c_addr);
+// Render screen using the configured buffer mode
+void display_render(u8g2_t *u8g2, display_draw_fn draw, const void *ctx);
 // Draw status text
 void display_draw_status(u8g2_t *u8g2, const char *line1, const char *line2);
-// Animate a simple progress bar
-void display_progress_bar(u8g2_t *u8g2);
+// Animate a simple progress bar below the screen drawn by draw
+void display_progress_bar(u8g2_t *u8g2, display_draw_fn draw, const void *ctx);
 
 #endif // DISPLAY_H
@@ -0,0 +1,264 @@
+/** 
+ * Author: Jakub Lůčný (xlucnyj00)
+ * Date: 18.10.2026
+ * 
+ * VUT FIT IMP 2025
+ */
+
+#include <math.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "driver/gpio.h"
+#include "display_policy.h"
+#include "i2c_bus.h"
+
+#define TAG "DisplayPolicy"
+
+// Nominal frames per minute of each mode (6 s cycle, 2 x 21 animation frames)
+#define FRAMES_PER_MIN_ANIMATED     420
+#define FRAMES_PER_MIN_STATIC       20
+#define FRAMES_PER_MIN_ON_CHANGE    10
+
+// Estimated bytes of one full frame: 1024 B of pixels plus page addressing and control bytes
+#define FRAME_BYTES_EST             1100
+
+// Mode statistics are used instead of nominal cost after this observation time
+#define MODE_STATS_MIN_MS           60000
+
+/* Rough SSD1306 module current model (3.3 V, ~30 % pixels lit):
+    panel in power save ~10 uA, on ~3 mA plus up to ~12 mA scaled by contrast,
+    bus pull-ups (4.7 kOhm) draw ~0.7 mA while SDA/SCL are actively driven
+*/
+#define CURRENT_SLEEP_UA            10
+#define CURRENT_BASE_UA             3000
+#define CURRENT_CONTRAST_UA         12000
+#define CURRENT_BUS_ACTIVE_UA       700
+
+static const char *const s_mode_names[DISPLAY_MODE_COUNT] = {
+    "animated", "static", "on-change", "off"
+};
+static const uint8_t s_mode_contrast[DISPLAY_MODE_COUNT] = { 255, 128, 32, 0 };
+static const uint32_t s_mode_frames_per_min[DISPLAY_MODE_COUNT] = {
+    FRAMES_PER_MIN_ANIMATED, FRAMES_PER_MIN_STATIC, FRAMES_PER_MIN_ON_CHANGE, 0
+};
+
+// Time spent and display bytes sent in each mode
+typedef struct {
+    uint32_t ms;
+    uint32_t bytes;
+} mode_stats_t;
+
+static u8g2_t *s_u8g2 = NULL;
+static TaskHandle_t s_task = NULL;
+static display_mode_t s_mode = DISPLAY_MODE_COUNT;
+static power_source_t s_power = CONFIG_POWER_SOURCE;
+static mode_stats_t s_stats[DISPLAY_MODE_COUNT];
+
+static uint32_t s_last_update_ms = 0;
+static uint32_t s_last_disp_bytes = 0;
+static uint32_t s_last_other_bytes = 0;
+static uint32_t s_other_bpm = 0;            /*!< Non-display bus traffic in bytes per minute */
+static volatile uint32_t s_last_wake_ms = 0;
+
+// Last values shown on the display; kept across mode switches as reference for wake
+static volatile float s_shown_t = NAN;
+static volatile float s_shown_h = NAN;
+static volatile bool s_redraw = true;       /*!< Mode switched, next on-change check redraws */
+
+static uint32_t now_ms(void) {
+    return (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS);
+}
+
+static uint32_t other_bus_bytes(void) {
+    uint32_t sum = 0;
+    for (int i = 0; i < I2C_DEV_COUNT; i++) {
+        if (i != I2C_DEV_DISPLAY) sum += i2c_bus_bytes(i);
+    }
+    return sum;
+}
+
+// Display bytes per minute: measured once the mode ran long enough, nominal before that
+static uint32_t mode_bytes_per_min(display_mode_t mode) {
+    const mode_stats_t *st = &s_stats[mode];
+    if (st->ms >= MODE_STATS_MIN_MS) {
+        return (uint32_t)((uint64_t)st->bytes * 60000 / st->ms);
+    }
+    return s_mode_frames_per_min[mode] * FRAME_BYTES_EST;
+}
+
+static uint32_t mode_current_ua(display_mode_t mode) {
+    uint32_t capacity_bpm = i2c_bus_capacity_bps(I2C_DEV_DISPLAY) * 60;
+    uint32_t bus_ua = (uint32_t)((uint64_t)CURRENT_BUS_ACTIVE_UA * mode_bytes_per_min(mode) / capacity_bpm);
+    if (mode == DISPLAY_MODE_OFF) {
+        return CURRENT_SLEEP_UA + bus_ua;
+    }
+    return CURRENT_BASE_UA + CURRENT_CONTRAST_UA * s_mode_contrast[mode] / 255 + bus_ua;
+}
+
+// Pick the richest mode which fits into bus budget (mains) or power plan (battery)
+static display_mode_t select_mode(uint32_t now) {
+    if (CONFIG_DISPLAY_MODE >= 0 && CONFIG_DISPLAY_MODE < DISPLAY_MODE_COUNT) {
+        return (display_mode_t)CONFIG_DISPLAY_MODE;
+    }
+
+    if (s_power == POWER_SOURCE_BATTERY) {
+        return (now - s_last_wake_ms >= CONFIG_DISPLAY_OFF_TIMEOUT_MS) ? DISPLAY_MODE_OFF : DISPLAY_MODE_ON_CHANGE;
+    }
+
+    // Capacity follows the clock negotiated for the display, other traffic is small
+    uint64_t capacity_bpm = (uint64_t)i2c_bus_capacity_bps(I2C_DEV_DISPLAY) * 60;
+    uint32_t budget_bpm = (uint32_t)(capacity_bpm * CONFIG_DISPLAY_BUS_BUDGET_PCT / 100);
+    for (int mode = DISPLAY_MODE_ANIMATED; mode < DISPLAY_MODE_ON_CHANGE; mode++) {
+        if (s_other_bpm + mode_bytes_per_min(mode) <= budget_bpm) {
+            return (display_mode_t)mode;
+        }
+    }
+    return DISPLAY_MODE_ON_CHANGE;
+}
+
+static void apply_mode(display_mode_t mode) {
+    if (mode == DISPLAY_MODE_OFF) {
+        u8g2_SetPowerSave(s_u8g2, 1);
+    }
+    else {
+        u8g2_SetContrast(s_u8g2, s_mode_contrast[mode]);
+        u8g2_SetPowerSave(s_u8g2, 0);
+    }
+    // Force redraw of on-change screen after mode switch
+    s_redraw = true;
+    ESP_LOGI(TAG, "Display mode: %s", s_mode_names[mode]);
+}
+
+// Wake button interrupt, same as display_policy_wake
+static void IRAM_ATTR wake_button_isr(void *arg) {
+    BaseType_t woken = pdFALSE;
+    s_last_wake_ms = (uint32_t)(xTaskGetTickCountFromISR() * portTICK_PERIOD_MS);
+    if (s_task) {
+        vTaskNotifyGiveFromISR(s_task, &woken);
+    }
+    portYIELD_FROM_ISR(woken);
+}
+
+static void wake_button_init(void) {
+    if (CONFIG_DISPLAY_WAKE_GPIO < 0) return;
+
+    gpio_config_t cfg = {
+        .pin_bit_mask = 1ULL << CONFIG_DISPLAY_WAKE_GPIO,
+        .mode = GPIO_MODE_INPUT,
+        .pull_up_en = GPIO_PULLUP_ENABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type = GPIO_INTR_NEGEDGE,
+    };
+    esp_err_t err = gpio_config(&cfg);
+    if (err == ESP_OK) {
+        // Service may already be installed by another module
+        err = gpio_install_isr_service(0);
+        if (err == ESP_ERR_INVALID_STATE) err = ESP_OK;
+    }
+    if (err == ESP_OK) {
+        err = gpio_isr_handler_add(CONFIG_DISPLAY_WAKE_GPIO, wake_button_isr, NULL);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Wake button on GPIO %d unavailable: %s", CONFIG_DISPLAY_WAKE_GPIO, esp_err_to_name(err));
+    }
+}
+
+// Initialize policy; must be called from the task that renders the display
+void display_policy_init(u8g2_t *u8g2) {
+    s_u8g2 = u8g2;
+    s_task = xTaskGetCurrentTaskHandle();
+    s_last_update_ms = now_ms();
+    s_last_wake_ms = s_last_update_ms;
+    s_last_disp_bytes = i2c_bus_bytes(I2C_DEV_DISPLAY);
+    s_last_other_bytes = other_bus_bytes();
+    wake_button_init();
+}
+
+// Account elapsed interval to current mode, then select and apply next mode
+display_mode_t display_policy_update(void) {
+    uint32_t now = now_ms();
+    uint32_t elapsed = now - s_last_update_ms;
+    uint32_t disp_bytes = i2c_bus_bytes(I2C_DEV_DISPLAY);
+    uint32_t other_bytes = other_bus_bytes();
+
+    if (s_mode < DISPLAY_MODE_COUNT) {
+        s_stats[s_mode].ms += elapsed;
+        s_stats[s_mode].bytes += disp_bytes - s_last_disp_bytes;
+    }
+    if (elapsed > 0) {
+        s_other_bpm = (uint32_t)((uint64_t)(other_bytes - s_last_other_bytes) * 60000 / elapsed);
+    }
+    s_last_update_ms = now;
+    s_last_disp_bytes = disp_bytes;
+    s_last_other_bytes = other_bytes;
+
+    display_mode_t next = select_mode(now);
+    if (next != s_mode) {
+        apply_mode(next);
+        s_mode = next;
+    }
+    return s_mode;
+}
+
+// Block display task for up to ms, returns early when notified
+void display_policy_wait(uint32_t ms) {
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(ms));
+}
+
+// Returns true if values moved outside deadband around last shown ones
+bool display_policy_take_changed(float temp, float hum) {
+    if (!s_redraw && !isnan(s_shown_t) && fabsf(temp - s_shown_t) < CONFIG_DISPLAY_DEADBAND_T &&
+        !isnan(s_shown_h) && fabsf(hum - s_shown_h) < CONFIG_DISPLAY_DEADBAND_H) {
+        return false;
+    }
+    s_shown_t = temp;
+    s_shown_h = hum;
+    s_redraw = false;
+    return true;
+}
+
+// Notify display task about new values; significant change also wakes the display
+void display_policy_on_sample(float temp, float hum) {
+    if (!s_task) return;
+
+    // Nothing shown yet counts as significant change
+    float dt = isnan(s_shown_t) ? INFINITY : fabsf(temp - s_shown_t);
+    float dh = isnan(s_shown_h) ? INFINITY : fabsf(hum - s_shown_h);
+    if (dt >= CONFIG_DISPLAY_WAKE_DELTA_T || dh >= CONFIG_DISPLAY_WAKE_DELTA_H) {
+        display_policy_wake();
+    }
+    else if (dt >= CONFIG_DISPLAY_DEADBAND_T || dh >= CONFIG_DISPLAY_DEADBAND_H) {
+        xTaskNotifyGive(s_task);
+    }
+}
+
+// Restart off timeout and let the display task re-evaluate its mode
+void display_policy_wake(void) {
+    s_last_wake_ms = now_ms();
+    if (s_task) {
+        xTaskNotifyGive(s_task);
+    }
+}
+
+// Change power source, e.g. from board specific detection
+void display_policy_set_power_source(power_source_t src) {
+    s_power = src;
+    display_policy_wake();
+}
+
+// Log per-mode time, I2C bytes per minute and estimated current draw
+void display_policy_report(void) {
+    ESP_LOGI(TAG, "Mode: %s, power: %s, other bus traffic: %lu B/min, capacity: %lu B/min",
+            s_mode < DISPLAY_MODE_COUNT ? s_mode_names[s_mode] : "none",
+            s_power == POWER_SOURCE_BATTERY ? "battery" : "mains",
+            (unsigned long)s_other_bpm, (unsigned long)i2c_bus_capacity_bps(I2C_DEV_DISPLAY) * 60);
+
+    for (int mode = 0; mode < DISPLAY_MODE_COUNT; mode++) {
+        ESP_LOGI(TAG, "  %-9s time=%lus bytes/min=%lu%s current=%luuA",
+                s_mode_names[mode], (unsigned long)(s_stats[mode].ms / 1000),
+                (unsigned long)mode_bytes_per_min(mode),
+                s_stats[mode].ms >= MODE_STATS_MIN_MS ? "" : " (est)",
+                (unsigned long)mode_current_ua(mode));
+    }
+}
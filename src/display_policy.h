@@ -0,0 +1,81 @@
+/** 
+ * Author: Jakub Lůčný (xlucnyj00)
+ * Date: 18.10.2026
+ * 
+ * VUT FIT IMP 2025
+ */
+
+#ifndef DISPLAY_POLICY_H
+#define DISPLAY_POLICY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "u8g2.h"
+
+// Display modes ordered from the most to the least expensive
+typedef enum {
+    DISPLAY_MODE_ANIMATED = 0,  /*!< Alternating screens with animated progress bar */
+    DISPLAY_MODE_STATIC,        /*!< Alternating screens, no animation */
+    DISPLAY_MODE_ON_CHANGE,     /*!< Single dimmed screen redrawn only when values change */
+    DISPLAY_MODE_OFF,           /*!< Panel in power save, woken by significant change */
+    DISPLAY_MODE_COUNT
+} display_mode_t;
+
+typedef enum {
+    POWER_SOURCE_MAINS = 0,
+    POWER_SOURCE_BATTERY
+} power_source_t;
+
+// Forced display mode; -1 selects mode automatically
+#ifndef CONFIG_DISPLAY_MODE
+#define CONFIG_DISPLAY_MODE             -1
+#endif
+// Power source assumed at boot (no detection circuit on the board)
+#ifndef CONFIG_POWER_SOURCE
+#define CONFIG_POWER_SOURCE             POWER_SOURCE_MAINS
+#endif
+// Share of I2C bus capacity the display may use together with other devices
+#ifndef CONFIG_DISPLAY_BUS_BUDGET_PCT
+#define CONFIG_DISPLAY_BUS_BUDGET_PCT   80
+#endif
+// On battery the panel is turned off after this time without wake event
+#ifndef CONFIG_DISPLAY_OFF_TIMEOUT_MS
+#define CONFIG_DISPLAY_OFF_TIMEOUT_MS   60000
+#endif
+// Change from last shown values that triggers redraw in on-change mode
+#ifndef CONFIG_DISPLAY_DEADBAND_T
+#define CONFIG_DISPLAY_DEADBAND_T       0.1f
+#endif
+#ifndef CONFIG_DISPLAY_DEADBAND_H
+#define CONFIG_DISPLAY_DEADBAND_H       0.5f
+#endif
+// Change from last shown values that wakes the display
+#ifndef CONFIG_DISPLAY_WAKE_DELTA_T
+#define CONFIG_DISPLAY_WAKE_DELTA_T     1.0f
+#endif
+#ifndef CONFIG_DISPLAY_WAKE_DELTA_H
+#define CONFIG_DISPLAY_WAKE_DELTA_H     5.0f
+#endif
+// Button (to GND) waking the display; BOOT button of the devkit, -1 disables
+#ifndef CONFIG_DISPLAY_WAKE_GPIO
+#define CONFIG_DISPLAY_WAKE_GPIO        0
+#endif
+
+// Initialize policy; must be called from the task that renders the display
+void display_policy_init(u8g2_t *u8g2);
+// Select mode from bus utilisation and power source, apply contrast/power save on change
+display_mode_t display_policy_update(void);
+// Block display task for up to ms, returns early on new values or wake event
+void display_policy_wait(uint32_t ms);
+// Returns true if values differ from the last shown ones by more than deadband; records them as shown
+bool display_policy_take_changed(float temp, float hum);
+// Notify policy about a new sample; wakes display on significant change
+void display_policy_on_sample(float temp, float hum);
+// Wake display from off mode
+void display_policy_wake(void);
+// Change power source, e.g. from board specific detection
+void display_policy_set_power_source(power_source_t src);
+// Log per-mode time, I2C bytes per minute and estimated current draw
+void display_policy_report(void);
+
+#endif // DISPLAY_POLICY_H
@@ -16,11 +16,33 @@
 
 #include "i2c_bus.h"
 #include "esp_err.h"
+#include "esp_log.h"
+#include "esp_timer.h"
 #include "sdkconfig.h"
 
+#define TAG "I2C"
+
+// Fast Mode clock tried when the preferred speed of a device fails its probe
+#define I2C_FAST_MODE_HZ    400000
+
+// Per-device handle, negotiated clock and traffic; counters have a single writer task
+typedef struct {
+    i2c_master_dev_handle_t handle;
+    uint32_t speed_hz;
+    volatile uint32_t bytes;    /*!< Bytes including address byte */
+    volatile uint32_t busy_us;  /*!< Time spent in transfers, wraps after ~71 min */
+} i2c_dev_t;
+
+static const char *const s_dev_names[I2C_DEV_COUNT] = {
+    [I2C_DEV_DISPLAY] = "display",
+    [I2C_DEV_SENSOR]  = "sensor",
+};
+
 // I2C master bus handle shared across modules
 i2c_master_bus_handle_t g_i2c_bus = NULL;
 
+static i2c_dev_t s_devs[I2C_DEV_COUNT];
+
 // Set up the I2C master bus using default clock and used pins
 void i2c_bus_init(void) {
     i2c_master_bus_config_t bus_cfg = {
@@ -33,3 +55,132 @@ void i2c_bus_init(void) {
     };
     ESP_ERROR_CHECK(i2c_new_master_bus(&bus_cfg, &g_i2c_bus));
 }
+
+static esp_err_t add_at_speed(i2c_dev_id_t dev, uint16_t addr, uint32_t speed_hz) {
+    i2c_device_config_t cfg = {
+        .dev_addr_length = I2C_ADDR_BIT_LEN_7,
+        .device_address = addr,
+        .scl_speed_hz = speed_hz,
+    };
+    s_devs[dev].speed_hz = speed_hz;
+    return i2c_master_bus_add_device(g_i2c_bus, &cfg, &s_devs[dev].handle);
+}
+
+static void remove_dev(i2c_dev_id_t dev) {
+    if (s_devs[dev].handle) {
+        i2c_master_bus_rm_device(s_devs[dev].handle);
+    }
+    s_devs[dev].handle = NULL;
+    s_devs[dev].speed_hz = 0;
+}
+
+// Try preferred speed, Fast Mode and the configured bus frequency in that order;
+// a speed is kept only if every probe round passes. When all fail, the device stays
+// added at the slowest speed so a late-starting device can still be used.
+esp_err_t i2c_bus_add_device(i2c_dev_id_t dev, uint16_t addr, uint32_t speed_hz, i2c_bus_probe_fn probe) {
+    const uint32_t ladder[] = { speed_hz, I2C_FAST_MODE_HZ, CONFIG_I2C_MASTER_FREQUENCY };
+    uint32_t tried = UINT32_MAX;
+    esp_err_t err = ESP_ERR_NOT_FOUND;
+
+    for (size_t i = 0; i < sizeof(ladder) / sizeof(ladder[0]); i++) {
+        if (ladder[i] >= tried) continue;
+        tried = ladder[i];
+
+        remove_dev(dev);
+        err = add_at_speed(dev, addr, tried);
+        for (int round = 0; err == ESP_OK && probe && round < CONFIG_I2C_PROBE_ROUNDS; round++) {
+            err = probe(dev);
+        }
+        if (err == ESP_OK) {
+            ESP_LOGI(TAG, "%s (0x%02x) at %lu kHz", s_dev_names[dev], addr, (unsigned long)(tried / 1000));
+            return ESP_OK;
+        }
+        ESP_LOGW(TAG, "%s (0x%02x) probe at %lu kHz failed: %s", s_dev_names[dev], addr,
+                (unsigned long)(tried / 1000), esp_err_to_name(err));
+    }
+
+    if (!s_devs[dev].handle) {
+        add_at_speed(dev, addr, tried);
+    }
+    return err;
+}
+
+static void account(i2c_dev_id_t dev, size_t len, int64_t start_us) {
+    s_devs[dev].bytes += len + 1;
+    s_devs[dev].busy_us += (uint32_t)(esp_timer_get_time() - start_us);
+}
+
+// Write one transaction
+esp_err_t i2c_bus_transmit(i2c_dev_id_t dev, const uint8_t *buf, size_t len) {
+    if (!s_devs[dev].handle) return ESP_ERR_INVALID_STATE;
+    int64_t start = esp_timer_get_time();
+    esp_err_t err = i2c_master_transmit(s_devs[dev].handle, buf, len, I2C_BUS_TIMEOUT_MS);
+    account(dev, len, start);
+    return err;
+}
+
+// Write several buffers as one transaction without copying them together
+esp_err_t i2c_bus_transmit_multi(i2c_dev_id_t dev, i2c_master_transmit_multi_buffer_info_t *bufs, size_t count) {
+    if (!s_devs[dev].handle) return ESP_ERR_INVALID_STATE;
+    size_t len = 0;
+    for (size_t i = 0; i < count; i++) {
+        len += bufs[i].buffer_size;
+    }
+    int64_t start = esp_timer_get_time();
+    esp_err_t err = i2c_master_multi_buffer_transmit(s_devs[dev].handle, bufs, count, I2C_BUS_TIMEOUT_MS);
+    account(dev, len, start);
+    return err;
+}
+
+// Read one transaction
+esp_err_t i2c_bus_receive(i2c_dev_id_t dev, uint8_t *buf, size_t len) {
+    if (!s_devs[dev].handle) return ESP_ERR_INVALID_STATE;
+    int64_t start = esp_timer_get_time();
+    esp_err_t err = i2c_master_receive(s_devs[dev].handle, buf, len, I2C_BUS_TIMEOUT_MS);
+    account(dev, len, start);
+    return err;
+}
+
+// Negotiated SCL clock of device (0 if not added)
+uint32_t i2c_bus_speed(i2c_dev_id_t dev) {
+    return s_devs[dev].speed_hz;
+}
+
+// Bus capacity in bytes per second at device clock, configured frequency before negotiation
+uint32_t i2c_bus_capacity_bps(i2c_dev_id_t dev) {
+    uint32_t hz = s_devs[dev].speed_hz ? s_devs[dev].speed_hz : CONFIG_I2C_MASTER_FREQUENCY;
+    return hz / 9;
+}
+
+// Total bytes transferred to/from device since boot
+uint32_t i2c_bus_bytes(i2c_dev_id_t dev) {
+    return s_devs[dev].bytes;
+}
+
+// Throughput is bytes over time spent in transfers, so it includes driver overhead
+// and shows how close transfers get to the clock limit; busy is share of wall time
+void i2c_bus_report(void) {
+    static uint32_t s_last_bytes[I2C_DEV_COUNT];
+    static uint32_t s_last_busy_us[I2C_DEV_COUNT];
+    static int64_t s_last_us;
+
+    int64_t now = esp_timer_get_time();
+    int64_t wall_us = now - s_last_us;
+    s_last_us = now;
+
+    for (int i = 0; i < I2C_DEV_COUNT; i++) {
+        uint32_t bytes = s_devs[i].bytes;
+        uint32_t busy = s_devs[i].busy_us;
+        uint32_t d_bytes = bytes - s_last_bytes[i];
+        uint32_t d_busy = busy - s_last_busy_us[i];
+        s_last_bytes[i] = bytes;
+        s_last_busy_us[i] = busy;
+
+        ESP_LOGI(TAG, "%-8s %4lu kHz  %lu B  %lu B/s of %lu B/s  busy %lu.%lu%%",
+                s_dev_names[i], (unsigned long)(s_devs[i].speed_hz / 1000), (unsigned long)d_bytes,
+                d_busy ? (unsigned long)((uint64_t)d_bytes * 1000000 / d_busy) : 0UL,
+                (unsigned long)i2c_bus_capacity_bps(i),
+                wall_us > 0 ? (unsigned long)((uint64_t)d_busy * 100 / wall_us) : 0UL,
+                wall_us > 0 ? (unsigned long)((uint64_t)d_busy * 1000 / wall_us % 10) : 0UL);
+    }
+}
@@ -8,6 +8,7 @@
 #ifndef I2C_BUS_H
 #define I2C_BUS_H
 
+#include <stddef.h>
 #include <stdint.h>
 #include "driver/i2c_master.h"
 
@@ -15,10 +16,54 @@
 #define I2C_SDA_PIN 21
 #define I2C_SCL_PIN 22
 
+#define I2C_BUS_TIMEOUT_MS  1000
+
+/* Preferred SCL clock per device; a device failing its boot probe falls back to
+    400 kHz Fast Mode and then to CONFIG_I2C_MASTER_FREQUENCY.
+    The SSD1306 cannot be read back, its probe only sees the ACK, so a clock at which
+    pixel data gets corrupted can pass. Above 400 kHz (e.g. 1 MHz) is therefore opt-in
+    and needs external pull-ups (~2.2 kOhm); the internal ones are far too weak for it.
+*/
+#ifndef CONFIG_I2C_DISPLAY_FREQUENCY
+#define CONFIG_I2C_DISPLAY_FREQUENCY    400000
+#endif
+#ifndef CONFIG_I2C_SENSOR_FREQUENCY
+#define CONFIG_I2C_SENSOR_FREQUENCY     400000
+#endif
+
+// Successful probes required at a speed before it is accepted
+#ifndef CONFIG_I2C_PROBE_ROUNDS
+#define CONFIG_I2C_PROBE_ROUNDS         3
+#endif
+
+// Devices sharing the bus, used for traffic accounting
+typedef enum {
+    I2C_DEV_DISPLAY = 0,
+    I2C_DEV_SENSOR,
+    I2C_DEV_COUNT
+} i2c_dev_id_t;
+
+// Check that device answers correctly at the speed it was added with
+typedef esp_err_t (*i2c_bus_probe_fn)(i2c_dev_id_t dev);
+
 // Global handle to the initialized I2C master bus
 extern i2c_master_bus_handle_t g_i2c_bus;
 
 // Initialize the I2C master bus with configured pins and pull up resistors
 void i2c_bus_init(void);
+// Add device at the fastest speed up to speed_hz which passes its probe
+esp_err_t i2c_bus_add_device(i2c_dev_id_t dev, uint16_t addr, uint32_t speed_hz, i2c_bus_probe_fn probe);
+// Timed and accounted transfers with a device added by i2c_bus_add_device
+esp_err_t i2c_bus_transmit(i2c_dev_id_t dev, const uint8_t *buf, size_t len);
+esp_err_t i2c_bus_transmit_multi(i2c_dev_id_t dev, i2c_master_transmit_multi_buffer_info_t *bufs, size_t count);
+esp_err_t i2c_bus_receive(i2c_dev_id_t dev, uint8_t *buf, size_t len);
+// Negotiated SCL clock of device (0 if not added)
+uint32_t i2c_bus_speed(i2c_dev_id_t dev);
+// Bus capacity in bytes per second at device clock (9 clock cycles per byte including ACK)
+uint32_t i2c_bus_capacity_bps(i2c_dev_id_t dev);
+// Total bytes transferred to/from device since boot
+uint32_t i2c_bus_bytes(i2c_dev_id_t dev);
+// Log clock, traffic and achieved throughput of each device since the last report
+void i2c_bus_report(void);
 
 #endif // I2C_BUS_H
@@ -11,6 +11,7 @@
 #include <stdbool.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/queue.h"
 #include "esp_log.h"
 #include "esp_event.h"
 #include "esp_system.h"
@@ -25,6 +26,12 @@
 #include "portal.h"
 #include "sensor.h"
 #include "mqtt.h"
+#include "tasks.h"
+#include "memstat.h"
+#include "display_policy.h"
+#include "sampler.h"
+#include "app_config.h"
+#include "telemetry.h"
 
 #define TAG "Meteostation"
 
@@ -36,12 +43,185 @@
 
 #define WIFI_CONNECT_TIMEOUT_MS 10000
 
-#ifndef CONFIG_MQTT_BROKER_URI
-#define CONFIG_MQTT_BROKER_URI "mqtt://broker.hivemq.com:1883"
-#endif
-#ifndef CONFIG_MQTT_TOPIC
-#define CONFIG_MQTT_TOPIC "meteostanice/measurements"
-#endif
+// Time each screen is shown in static mode and screen cycle of on-change/off modes
+#define DISPLAY_SCREEN_MS       3000
+#define DISPLAY_CYCLE_MS        (2 * DISPLAY_SCREEN_MS)
+
+// Display state; must outlive app_main as it is used by the display task
+static u8g2_t s_u8g2;
+
+// Base MQTT topic of this device (topic template with device id expanded)
+static char s_base_topic[TELEMETRY_TOPIC_MAX];
+
+// Latest measurement (queue of length 1, overwritten by sampler, peeked by display)
+static QueueHandle_t s_meas_queue = NULL;
+static StaticQueue_t s_meas_queue_buf;
+static uint8_t s_meas_queue_storage[sizeof(measurement_t)];
+
+/****************************************************************************
+    Sampler task: reads sensor and publishes via MQTT; interval adapts to
+    rate of change of the values and to MQTT uplink backlog
+****************************************************************************/
+static void sampler_task(void *arg) {
+    static telemetry_msg_t msgs[TELEMETRY_MAX_MSGS];
+    sampler_t sampler;
+    telemetry_t telemetry;
+
+    sampler_init(&sampler, &g_app_config.sampler);
+    telemetry_init(&telemetry, s_base_topic, CONFIG_MQTT_SLOW_PERIOD_MS,
+                   (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS));
+
+    TickType_t last_wake = xTaskGetTickCount();
+    while (1) {
+        measurement_t m;
+        if (!sensor_read(&m.temp, &m.hum)) {
+            // Nothing published and sampler state kept; retry after the current interval
+            ESP_LOGW(TAG, "Sensor read failed");
+            vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(sampler.interval_ms));
+            continue;
+        }
+
+        uint32_t now = (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS);
+        uint32_t interval = sampler_next_interval(&sampler, m.temp, m.hum, now,
+                                                  mqtt_backlog_bytes(sampler.limits.backlog_high));
+
+        ESP_LOGI(TAG, "T=%.2fC H=%.2f%% next in %lums", m.temp, m.hum, (unsigned long)interval);
+        int n = telemetry_on_sample(&telemetry, m.temp, m.hum, interval, now, msgs, TELEMETRY_MAX_MSGS);
+        for (int i = 0; i < n; i++) {
+            mqtt_publish(msgs[i].topic, msgs[i].payload, msgs[i].qos, msgs[i].retain);
+        }
+        xQueueOverwrite(s_meas_queue, &m);
+        display_policy_on_sample(m.temp, m.hum);
+
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(interval));
+    }
+}
+
+// Icon of a thermometer
+// Generated from free icon at https://javl.github.io/image2cpp/
+static const uint8_t thermo_bitmap[] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xe0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x01, 
+    0x00, 0x00, 0x00, 0x00, 0x18, 0x03, 0x00, 0x00, 0x00, 0x00, 0x58, 0x3a, 0x00, 0x00, 0x00, 0x00, 
+    0x58, 0x7a, 0x00, 0x00, 0x00, 0x00, 0x58, 0x02, 0x00, 0x00, 0x00, 0x00, 0x58, 0x1a, 0x00, 0x00, 
+    0x00, 0x00, 0x58, 0x02, 0x00, 0x00, 0x00, 0x00, 0x58, 0x02, 0x00, 0x00, 0x00, 0x00, 0x58, 0x7a, 
+    0x00, 0x00, 0x00, 0x00, 0x58, 0x02, 0x00, 0x00, 0x00, 0x00, 0x58, 0x1e, 0x00, 0x00, 0x00, 0x00, 
+    0x58, 0x02, 0x00, 0x00, 0x00, 0x00, 0x58, 0x02, 0x00, 0x00, 0x00, 0x00, 0x58, 0x3a, 0x00, 0x00, 
+    0x00, 0x00, 0x58, 0x02, 0x00, 0x00, 0x00, 0x00, 0x58, 0x1a, 0x00, 0x00, 0x00, 0x00, 0x58, 0x02, 
+    0x00, 0x00, 0x00, 0x00, 0x58, 0x02, 0x00, 0x00, 0x00, 0x00, 0x58, 0x7a, 0x00, 0x00, 0x00, 0x00, 
+    0x48, 0x02, 0x00, 0x00, 0x00, 0x00, 0x4c, 0x06, 0x00, 0x00, 0x00, 0x00, 0xf4, 0x05, 0x00, 0x00, 
+    0x00, 0x00, 0xf6, 0x09, 0x00, 0x00, 0x00, 0x00, 0xfa, 0x0b, 0x00, 0x00, 0x00, 0x00, 0xfa, 0x0b, 
+    0x00, 0x00, 0x00, 0x00, 0xf4, 0x0d, 0x00, 0x00, 0x00, 0x00, 0x44, 0x04, 0x00, 0x00, 0x00, 0x00, 
+    0x18, 0x03, 0x00, 0x00, 0x00, 0x00, 0xf0, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+
+// Icon of a humidity
+// Generated from free icon at https://javl.github.io/image2cpp/
+static const uint8_t humidity_bitmap[] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x01, 0x00, 0x00, 0x00, 0x00, 0xc0, 0x03, 0x00, 0x00, 
+    0x00, 0x00, 0x40, 0x02, 0x00, 0x00, 0x00, 0x00, 0x20, 0x04, 0x00, 0x00, 0x00, 0x00, 0x10, 0x08, 
+    0x00, 0x00, 0x00, 0x00, 0x08, 0x10, 0x00, 0x00, 0x00, 0x00, 0x0c, 0x30, 0x00, 0x00, 0x00, 0x00, 
+    0x04, 0x60, 0x00, 0x00, 0x00, 0x00, 0x02, 0x40, 0x00, 0x00, 0x00, 0x00, 0x03, 0x80, 0x00, 0x00, 
+    0x00, 0x00, 0x01, 0x80, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x01, 0x00, 0x00, 0xc0, 0x00, 0x00, 
+    0x03, 0x00, 0x00, 0x40, 0x00, 0x00, 0x02, 0x00, 0x00, 0x60, 0x00, 0x00, 0x06, 0x00, 0x00, 0x20, 
+    0x00, 0x00, 0x04, 0x00, 0x00, 0x20, 0x00, 0x00, 0x04, 0x00, 0x00, 0x10, 0x70, 0x04, 0x08, 0x00, 
+    0x00, 0x10, 0x48, 0x04, 0x08, 0x00, 0x00, 0x10, 0x48, 0x02, 0x18, 0x00, 0x00, 0x18, 0x48, 0x02, 
+    0x10, 0x00, 0x00, 0x08, 0x70, 0x01, 0x10, 0x00, 0x00, 0x08, 0x00, 0x1d, 0x10, 0x00, 0x00, 0x08, 
+    0x80, 0x14, 0x10, 0x00, 0x00, 0x08, 0x80, 0x22, 0x10, 0x00, 0x00, 0x08, 0x40, 0x14, 0x10, 0x00, 
+    0x00, 0x08, 0x40, 0x1c, 0x10, 0x00, 0x00, 0x18, 0x00, 0x00, 0x18, 0x00, 0x00, 0x10, 0x00, 0x00, 
+    0x08, 0x00, 0x00, 0x30, 0x00, 0x00, 0x0c, 0x00, 0x00, 0x20, 0x00, 0x00, 0x04, 0x00, 0x00, 0x40, 
+    0x00, 0x00, 0x02, 0x00, 0x00, 0x80, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x03, 0xc0, 0x00, 0x00, 
+    0x00, 0x00, 0x1e, 0x78, 0x00, 0x00, 0x00, 0x00, 0xf0, 0x0f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+
+// Draw temperature screen; ctx points to measurement_t
+static void draw_temperature(u8g2_t *u8g2, const void *ctx) {
+    const measurement_t *m = ctx;
+    char line[16];
+
+    u8g2_SetFont(u8g2, u8g2_font_ncenB14_tr);
+    snprintf(line, sizeof(line), "%.1f  C", m->temp);
+    u8g2_DrawStr(u8g2, 15, 38, line);
+
+    // Circle serving as degree symbol
+    u8g2_DrawCircle(u8g2, 59, 25, 2, U8G2_DRAW_ALL);
+
+    // Display bitmap thermometer
+    u8g2_DrawXBM(u8g2, 80, 8, 48, 48, thermo_bitmap);
+}
+
+// Draw humidity screen; ctx points to measurement_t
+static void draw_humidity(u8g2_t *u8g2, const void *ctx) {
+    const measurement_t *m = ctx;
+    char line[16];
+
+    u8g2_SetFont(u8g2, u8g2_font_ncenB14_tr);
+    snprintf(line, sizeof(line), "%.1f %%", m->hum);
+    u8g2_DrawStr(u8g2, 15, 38, line);
+
+    // Display bitmap humidity
+    u8g2_DrawXBM(u8g2, 80, 8, 48, 48, humidity_bitmap);
+}
+
+// Draw both values on a single screen; ctx points to measurement_t
+static void draw_summary(u8g2_t *u8g2, const void *ctx) {
+    const measurement_t *m = ctx;
+    char line[16];
+
+    u8g2_SetFont(u8g2, u8g2_font_ncenB14_tr);
+    snprintf(line, sizeof(line), "%.1f  C", m->temp);
+    u8g2_DrawStr(u8g2, 15, 28, line);
+    u8g2_DrawCircle(u8g2, 59, 15, 2, U8G2_DRAW_ALL);
+
+    snprintf(line, sizeof(line), "%.1f %%", m->hum);
+    u8g2_DrawStr(u8g2, 15, 54, line);
+}
+
+/****************************************************************************
+    Display task: shows latest temperature and humidity in the mode chosen
+    by display policy, one cycle takes ~6 seconds
+****************************************************************************/
+static void display_task(void *arg) {
+    u8g2_t *u8g2 = (u8g2_t *)arg;
+    display_policy_init(u8g2);
+    while (1) {
+        measurement_t m;
+        xQueuePeek(s_meas_queue, &m, portMAX_DELAY);
+
+        switch (display_policy_update()) {
+            case DISPLAY_MODE_ANIMATED:
+                // Each screen for 3 seconds with progress bar
+                display_progress_bar(u8g2, draw_temperature, &m);
+                display_progress_bar(u8g2, draw_humidity, &m);
+                break;
+            case DISPLAY_MODE_STATIC:
+                display_render(u8g2, draw_temperature, &m);
+                vTaskDelay(pdMS_TO_TICKS(DISPLAY_SCREEN_MS));
+                display_render(u8g2, draw_humidity, &m);
+                vTaskDelay(pdMS_TO_TICKS(DISPLAY_SCREEN_MS));
+                break;
+            case DISPLAY_MODE_ON_CHANGE:
+                if (display_policy_take_changed(m.temp, m.hum)) {
+                    display_render(u8g2, draw_summary, &m);
+                }
+                display_policy_wait(DISPLAY_CYCLE_MS);
+                break;
+            default:
+                // Panel is off; wait for wake event or next policy evaluation
+                display_policy_wait(DISPLAY_CYCLE_MS);
+                break;
+        }
+    }
+}
 
 /****************************************************************************
     Main application entry point
@@ -51,19 +231,23 @@ void app_main(void) {
     // ESP_LOGD(TAG, "TESTING: Erasing NVS!");
     // ESP_ERROR_CHECK(nvs_flash_erase());
 
+    memstat_mark("boot");
     nvs_init();
+    app_config_load();
+    app_config_topic(s_base_topic, sizeof(s_base_topic));
+    memstat_mark("nvs");
     wifi_sta_init();
+    memstat_mark("wifi");
     i2c_bus_init();
-
-    u8g2_t u8g2;
-    display_init(&u8g2, DISPLAY_ADDR);
+    display_init(&s_u8g2, DISPLAY_ADDR);
+    memstat_mark("display");
 
     // Try to load stored credentials from NVS
     char ssid[64] = {0}, pass[64] = {0};
     bool have_nvs = wifi_load_creds(ssid, sizeof(ssid), pass, sizeof(pass));
     if (!have_nvs) {
         // No credentials found; start config portal
-        portal_run_blocking(&u8g2);
+        portal_run_blocking(&s_u8g2);
     }
     else {
         // Found credentials, try to connect; if fails, open config portal
@@ -75,7 +259,7 @@ void app_main(void) {
         esp_wifi_set_config(WIFI_IF_STA, &sta);
         esp_wifi_start();
 
-        display_draw_status(&u8g2, "Wi-Fi connecting...", NULL);
+        display_draw_status(&s_u8g2, "Wi-Fi connecting...", NULL);
 
         EventBits_t bits = xEventGroupWaitBits(wifi_event_group,
                 BIT0,
@@ -86,108 +270,33 @@ void app_main(void) {
 
         if ((bits & BIT0) == 0) {
             // Connection failed; start SoftAP + portal
-            portal_run_blocking(&u8g2);
+            portal_run_blocking(&s_u8g2);
         }
 
         if (!portal_skip_no_mqtt) {
             // Connected; start MQTT client
-            display_draw_status(&u8g2, "Wi-Fi connected", NULL);
-            mqtt_start(CONFIG_MQTT_BROKER_URI);
+            display_draw_status(&s_u8g2, "Wi-Fi connected", NULL);
+            char status_topic[TELEMETRY_TOPIC_MAX];
+            telemetry_status_topic(s_base_topic, status_topic, sizeof(status_topic));
+            mqtt_start(g_app_config.broker_uri, status_topic);
+            memstat_mark("mqtt");
         }
     }
 
     if (portal_skip_no_mqtt) {
-        display_draw_status(&u8g2, "Started without data export", NULL);
+        display_draw_status(&s_u8g2, "Started without data export", NULL);
     }
 
     sensor_init();
 
-    /* Main application loop 
-        reads temperature and humidity data from sensor, displays it and publishes via MQTT
-        cycle repeats every ~6 seconds
-    */ 
-    while (1) {
-        float temp, hum;
-        sensor_read(&temp, &hum);
-
-        ESP_LOGI(TAG, "T=%.2fC H=%.2f%%", temp, hum);
-        mqtt_publish_values(temp, hum, CONFIG_MQTT_TOPIC);
-
-        // Display temperature
-        u8g2_ClearBuffer(&u8g2);
-        u8g2_SetFont(&u8g2, u8g2_font_ncenB14_tr);
-
-        char line[16];
-        snprintf(line, sizeof(line), "%.1f  C", temp);
-        u8g2_DrawStr(&u8g2, 15, 38, line);
-
-        // Circle serving as degree symbol
-        u8g2_DrawCircle(&u8g2, 59, 25, 2, U8G2_DRAW_ALL);
-
-        // Icon of a thermometer
-        // Generated from free icon at https://javl.github.io/image2cpp/
-        const uint8_t thermo_bitmap[] = {
-            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xe0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x01, 
-            0x00, 0x00, 0x00, 0x00, 0x18, 0x03, 0x00, 0x00, 0x00, 0x00, 0x58, 0x3a, 0x00, 0x00, 0x00, 0x00, 
-            0x58, 0x7a, 0x00, 0x00, 0x00, 0x00, 0x58, 0x02, 0x00, 0x00, 0x00, 0x00, 0x58, 0x1a, 0x00, 0x00, 
-            0x00, 0x00, 0x58, 0x02, 0x00, 0x00, 0x00, 0x00, 0x58, 0x02, 0x00, 0x00, 0x00, 0x00, 0x58, 0x7a, 
-            0x00, 0x00, 0x00, 0x00, 0x58, 0x02, 0x00, 0x00, 0x00, 0x00, 0x58, 0x1e, 0x00, 0x00, 0x00, 0x00, 
-            0x58, 0x02, 0x00, 0x00, 0x00, 0x00, 0x58, 0x02, 0x00, 0x00, 0x00, 0x00, 0x58, 0x3a, 0x00, 0x00, 
-            0x00, 0x00, 0x58, 0x02, 0x00, 0x00, 0x00, 0x00, 0x58, 0x1a, 0x00, 0x00, 0x00, 0x00, 0x58, 0x02, 
-            0x00, 0x00, 0x00, 0x00, 0x58, 0x02, 0x00, 0x00, 0x00, 0x00, 0x58, 0x7a, 0x00, 0x00, 0x00, 0x00, 
-            0x48, 0x02, 0x00, 0x00, 0x00, 0x00, 0x4c, 0x06, 0x00, 0x00, 0x00, 0x00, 0xf4, 0x05, 0x00, 0x00, 
-            0x00, 0x00, 0xf6, 0x09, 0x00, 0x00, 0x00, 0x00, 0xfa, 0x0b, 0x00, 0x00, 0x00, 0x00, 0xfa, 0x0b, 
-            0x00, 0x00, 0x00, 0x00, 0xf4, 0x0d, 0x00, 0x00, 0x00, 0x00, 0x44, 0x04, 0x00, 0x00, 0x00, 0x00, 
-            0x18, 0x03, 0x00, 0x00, 0x00, 0x00, 0xf0, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
-        };
-
-        // Display bitmap thermometer
-        u8g2_DrawXBM(&u8g2, 80, 8, 48, 48, thermo_bitmap);
-        u8g2_SendBuffer(&u8g2);
-
-        // Wait 3 seconds with progress bar
-        display_progress_bar(&u8g2);
-
-        u8g2_ClearBuffer(&u8g2);
-
-        // Display humidity
-        snprintf(line, sizeof(line), "%.1f %%", hum);
-        u8g2_DrawStr(&u8g2, 15, 38, line);
-
-        // Icon of a humidity
-        // Generated from free icon at https://javl.github.io/image2cpp/
-        const uint8_t humidity_bitmap[] = {
-            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x01, 0x00, 0x00, 0x00, 0x00, 0xc0, 0x03, 0x00, 0x00, 
-            0x00, 0x00, 0x40, 0x02, 0x00, 0x00, 0x00, 0x00, 0x20, 0x04, 0x00, 0x00, 0x00, 0x00, 0x10, 0x08, 
-            0x00, 0x00, 0x00, 0x00, 0x08, 0x10, 0x00, 0x00, 0x00, 0x00, 0x0c, 0x30, 0x00, 0x00, 0x00, 0x00, 
-            0x04, 0x60, 0x00, 0x00, 0x00, 0x00, 0x02, 0x40, 0x00, 0x00, 0x00, 0x00, 0x03, 0x80, 0x00, 0x00, 
-            0x00, 0x00, 0x01, 0x80, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x01, 0x00, 0x00, 0xc0, 0x00, 0x00, 
-            0x03, 0x00, 0x00, 0x40, 0x00, 0x00, 0x02, 0x00, 0x00, 0x60, 0x00, 0x00, 0x06, 0x00, 0x00, 0x20, 
-            0x00, 0x00, 0x04, 0x00, 0x00, 0x20, 0x00, 0x00, 0x04, 0x00, 0x00, 0x10, 0x70, 0x04, 0x08, 0x00, 
-            0x00, 0x10, 0x48, 0x04, 0x08, 0x00, 0x00, 0x10, 0x48, 0x02, 0x18, 0x00, 0x00, 0x18, 0x48, 0x02, 
-            0x10, 0x00, 0x00, 0x08, 0x70, 0x01, 0x10, 0x00, 0x00, 0x08, 0x00, 0x1d, 0x10, 0x00, 0x00, 0x08, 
-            0x80, 0x14, 0x10, 0x00, 0x00, 0x08, 0x80, 0x22, 0x10, 0x00, 0x00, 0x08, 0x40, 0x14, 0x10, 0x00, 
-            0x00, 0x08, 0x40, 0x1c, 0x10, 0x00, 0x00, 0x18, 0x00, 0x00, 0x18, 0x00, 0x00, 0x10, 0x00, 0x00, 
-            0x08, 0x00, 0x00, 0x30, 0x00, 0x00, 0x0c, 0x00, 0x00, 0x20, 0x00, 0x00, 0x04, 0x00, 0x00, 0x40, 
-            0x00, 0x00, 0x02, 0x00, 0x00, 0x80, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x03, 0xc0, 0x00, 0x00, 
-            0x00, 0x00, 0x1e, 0x78, 0x00, 0x00, 0x00, 0x00, 0xf0, 0x0f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
-        };
-
-        // Display bitmap humidity
-        u8g2_DrawXBM(&u8g2, 80, 8, 48, 48, humidity_bitmap);
-        u8g2_SendBuffer(&u8g2);
-
-        // Wait 3 seconds with progress bar
-        display_progress_bar(&u8g2);
-    }
+    /* Hand over to application tasks pinned to the APP core
+        sampler reads sensor and publishes via MQTT, display renders the latest values;
+        main task ends here and its stack is released
+    */
+    s_meas_queue = xQueueCreateStatic(1, sizeof(measurement_t), s_meas_queue_storage, &s_meas_queue_buf);
+    tasks_start(APP_TASK_SAMPLER, sampler_task, NULL);
+    tasks_start(APP_TASK_DISPLAY, display_task, &s_u8g2);
+    tasks_start_monitor();
+    memstat_mark("tasks");
+    memstat_report();
 }
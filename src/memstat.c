@@ -0,0 +1,92 @@
+/** 
+ * Author: Jakub Lůčný (xlucnyj00)
+ * Date: 18.10.2026
+ * 
+ * VUT FIT IMP 2025
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "memstat.h"
+#include "tasks.h"
+#include "display.h"
+#include "telemetry.h"
+#include "sensor.h"
+#include "mqtt.h"
+#include "portal.h"
+
+#define TAG "Memstat"
+
+// main.c: device base topic and the one-slot measurement queue with its control block
+#define MAIN_STATIC_BYTES (TELEMETRY_TOPIC_MAX + sizeof(measurement_t) + sizeof(StaticQueue_t))
+
+/* Statically allocated application memory, checked against the budget at build time.
+    Buffers and queues only; scalar module state (a few bytes each) is not counted.
+    A module adding a static buffer has to add it to its *_STATIC_BYTES.
+*/
+#define MEM_STATIC_BYTES (TASKS_STATIC_BYTES + DISPLAY_STATIC_BYTES + TELEMETRY_STATIC_BYTES + \
+                          MAIN_STATIC_BYTES + MQTT_STATIC_BYTES + PORTAL_STATIC_BYTES)
+
+_Static_assert(MEM_STATIC_BYTES <= CONFIG_MEM_BUDGET_STATIC_BYTES,
+               "Static memory exceeds CONFIG_MEM_BUDGET_STATIC_BYTES");
+
+// Heap state recorded after subsystem initialization
+typedef struct {
+    const char *name;
+    int32_t used;           /*!< Heap consumed since previous mark */
+    uint32_t free;          /*!< Free heap after initialization */
+    uint32_t largest;       /*!< Largest free block after initialization */
+    uint32_t min_free;      /*!< Minimum-ever free heap after initialization */
+} memstat_entry_t;
+
+static memstat_entry_t s_entries[MEMSTAT_MAX_SUBSYSTEMS];
+static int s_entry_cnt = 0;
+static uint32_t s_prev_free = 0;
+
+// Record heap state after subsystem initialization
+void memstat_mark(const char *subsystem) {
+    uint32_t free = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    if (s_prev_free == 0) {
+        s_prev_free = free;
+    }
+    if (s_entry_cnt >= MEMSTAT_MAX_SUBSYSTEMS) {
+        ESP_LOGW(TAG, "No slot left for subsystem %s", subsystem);
+        return;
+    }
+
+    memstat_entry_t *e = &s_entries[s_entry_cnt++];
+    e->name = subsystem;
+    e->used = (int32_t)s_prev_free - (int32_t)free;
+    e->free = free;
+    e->largest = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+    e->min_free = heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+    s_prev_free = free;
+}
+
+// Log static budget, current heap state and per-subsystem heap usage
+void memstat_report(void) {
+    uint32_t free = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    uint32_t largest = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+    uint32_t min_free = heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+
+    ESP_LOGI(TAG, "Static: %u of %u bytes (tasks %u, display %u, mqtt messages %u, portal %u, other %u)",
+            (unsigned)MEM_STATIC_BYTES, (unsigned)CONFIG_MEM_BUDGET_STATIC_BYTES,
+            (unsigned)TASKS_STATIC_BYTES, (unsigned)DISPLAY_STATIC_BYTES, (unsigned)TELEMETRY_STATIC_BYTES,
+            (unsigned)PORTAL_STATIC_BYTES, (unsigned)(MAIN_STATIC_BYTES + MQTT_STATIC_BYTES));
+    ESP_LOGI(TAG, "Heap: free=%lu largest=%lu min_free=%lu",
+            (unsigned long)free, (unsigned long)largest, (unsigned long)min_free);
+
+    for (int i = 0; i < s_entry_cnt; i++) {
+        const memstat_entry_t *e = &s_entries[i];
+        ESP_LOGI(TAG, "  %-8s used=%ld free=%lu largest=%lu min_free=%lu",
+                e->name, (long)e->used, (unsigned long)e->free,
+                (unsigned long)e->largest, (unsigned long)e->min_free);
+    }
+
+    if (min_free < CONFIG_MEM_BUDGET_HEAP_MIN_FREE) {
+        ESP_LOGW(TAG, "Minimum free heap %lu below budget %u",
+                (unsigned long)min_free, (unsigned)CONFIG_MEM_BUDGET_HEAP_MIN_FREE);
+    }
+}
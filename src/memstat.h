@@ -0,0 +1,29 @@
+/** 
+ * Author: Jakub Lůčný (xlucnyj00)
+ * Date: 18.10.2026
+ * 
+ * VUT FIT IMP 2025
+ */
+
+#ifndef MEMSTAT_H
+#define MEMSTAT_H
+
+// Upper limit for memory placed in .bss by the application (stacks, queues, buffers);
+// modules export their share as *_STATIC_BYTES, summed in memstat.c
+#ifndef CONFIG_MEM_BUDGET_STATIC_BYTES
+#define CONFIG_MEM_BUDGET_STATIC_BYTES  20480
+#endif
+// Warn when minimum-ever free heap drops below this value
+#ifndef CONFIG_MEM_BUDGET_HEAP_MIN_FREE
+#define CONFIG_MEM_BUDGET_HEAP_MIN_FREE 32768
+#endif
+
+// Maximum number of subsystems tracked by memstat_mark
+#define MEMSTAT_MAX_SUBSYSTEMS  12
+
+// Record heap state after subsystem initialization; heap consumed since previous mark is attributed to it
+void memstat_mark(const char *subsystem);
+// Log static budget, current heap state and per-subsystem heap usage
+void memstat_report(void);
+
+#endif // MEMSTAT_H
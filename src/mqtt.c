@@ -14,27 +14,92 @@
  * VUT FIT IMP 2025
  */
 
+#include <stdio.h>
+#include <string.h>
 #include "mqtt.h"
+#include "tasks.h"
+#include "telemetry.h"
+
+#define STATUS_ONLINE  "online"
+#define STATUS_OFFLINE "offline"
 
 // Handle to the MQTT client instance
 esp_mqtt_client_handle_t mqtt_client = NULL;
 
+// Status topic of this device, must outlive the client configuration
+static char s_status_topic[TELEMETRY_TOPIC_MAX];
+
+// Connection state written by the MQTT task
+static volatile bool s_connected = false;
+static volatile uint32_t s_connect_cnt = 0;
+
+// Bytes of messages dropped since the last connect; written by the publishing task only
+static uint32_t s_dropped_bytes = 0;
+static uint32_t s_dropped_connect_cnt = 0;
+
+// Announce device on every (re)connect; broker replaces it by Last Will on disconnect
+static void mqtt_event_handler(void *arg, esp_event_base_t base, int32_t id, void *data) {
+    if (id == MQTT_EVENT_CONNECTED) {
+        s_connected = true;
+        s_connect_cnt++;
+        esp_mqtt_client_publish(mqtt_client, s_status_topic, STATUS_ONLINE, 0, 1, 1);
+    }
+    else if (id == MQTT_EVENT_DISCONNECTED) {
+        s_connected = false;
+    }
+}
+
+// Forget drops made before the last connect
+static void dropped_sync(void) {
+    uint32_t cnt = s_connect_cnt;
+    if (cnt != s_dropped_connect_cnt) {
+        s_dropped_connect_cnt = cnt;
+        s_dropped_bytes = 0;
+    }
+}
+
 // Configure and start MQTT client using given broker URI
-void mqtt_start(const char *broker_uri) {
+void mqtt_start(const char *broker_uri, const char *status_topic) {
+    snprintf(s_status_topic, sizeof(s_status_topic), "%s", status_topic);
+
     esp_mqtt_client_config_t mqtt_cfg = {
         .broker.address.uri = broker_uri,
+        .session.last_will = {
+            .topic = s_status_topic,
+            .msg = STATUS_OFFLINE,
+            .qos = 1,
+            .retain = 1,
+        },
+        .task.priority = task_plan_mqtt.priority,
+        .task.stack_size = task_plan_mqtt.stack_size,
+        .buffer.size = CONFIG_MQTT_BUFFER_SIZE,
+        .buffer.out_size = CONFIG_MQTT_BUFFER_SIZE,
+        .outbox.limit = CONFIG_MQTT_OUTBOX_LIMIT,
     };
 
     mqtt_client = esp_mqtt_client_init(&mqtt_cfg);
     if (mqtt_client) {
+        esp_mqtt_client_register_event(mqtt_client, MQTT_EVENT_CONNECTED, mqtt_event_handler, NULL);
+        esp_mqtt_client_register_event(mqtt_client, MQTT_EVENT_DISCONNECTED, mqtt_event_handler, NULL);
         esp_mqtt_client_start(mqtt_client);
     }
 }
 
-// Publish temperature and humidity as JSON
-void mqtt_publish_values(float temp, float hum, const char *topic) {
+// Publish payload to topic; QoS 0 while disconnected and rejected messages count as dropped
+void mqtt_publish(const char *topic, const char *payload, int qos, int retain) {
     if (!mqtt_client) return;
-    char payload[128];
-    snprintf(payload, sizeof(payload), "{\"temp_c\":%.2f,\"hum\":%.2f}", temp, hum);
-    esp_mqtt_client_publish(mqtt_client, topic, payload, 0, 0, 0);
+    int ret = esp_mqtt_client_publish(mqtt_client, topic, payload, 0, qos, retain);
+    if (ret < 0 || (qos == 0 && !s_connected)) {
+        dropped_sync();
+        s_dropped_bytes += strlen(topic) + strlen(payload);
+    }
+}
+
+// QoS > 0 bytes waiting in the outbox plus bytes dropped since the last connect, up to dropped_cap
+uint32_t mqtt_backlog_bytes(uint32_t dropped_cap) {
+    if (!mqtt_client) return 0;
+    int size = esp_mqtt_client_get_outbox_size(mqtt_client);
+    dropped_sync();
+    uint32_t dropped = s_dropped_bytes < dropped_cap ? s_dropped_bytes : dropped_cap;
+    return (size > 0 ? (uint32_t)size : 0) + dropped;
 }
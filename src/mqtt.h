@@ -9,13 +9,33 @@
 #define MQTT_H
 
 #include "mqtt_client.h"
+#include "telemetry.h"
+
+// esp-mqtt receive and send buffer sizes (allocated once when the client starts)
+#ifndef CONFIG_MQTT_BUFFER_SIZE
+#define CONFIG_MQTT_BUFFER_SIZE     512
+#endif
+// Upper bound of heap held by messages waiting in the esp-mqtt outbox
+#ifndef CONFIG_MQTT_OUTBOX_LIMIT
+#define CONFIG_MQTT_OUTBOX_LIMIT    4096
+#endif
+
+// Static bytes of mqtt.c: status topic kept for the connect handler
+#define MQTT_STATIC_BYTES TELEMETRY_TOPIC_MAX
 
 // Global MQTT client handle used for publishing
 extern esp_mqtt_client_handle_t mqtt_client;
 
-// Initialize and start MQTT client for given broker URI
-void mqtt_start(const char *broker_uri);
-// Publish temperature and humidity JSON to specified topic
-void mqtt_publish_values(float temp, float hum, const char *topic);
+// Initialize and start MQTT client for given broker URI; status topic gets retained
+// "online" on connect and "offline" as Last Will
+void mqtt_start(const char *broker_uri, const char *status_topic);
+// Publish payload to topic
+void mqtt_publish(const char *topic, const char *payload, int qos, int retain);
+/* Uplink backlog in bytes (0 when client is not running). esp-mqtt keeps only QoS > 0
+    messages in its outbox, so QoS 0 messages published while disconnected and messages
+    rejected by a full outbox are counted too, until the next connect. The dropped part is
+    capped at dropped_cap, so a long outage does not grow it without bound.
+*/
+uint32_t mqtt_backlog_bytes(uint32_t dropped_cap);
 
 #endif // MQTT_H
@@ -20,8 +20,12 @@
 #include "lwip/ip4_addr.h"
 #include "esp_mac.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 
 #include "display.h"
+#include "tasks.h"
+#include "wifi.h"
+#include "bundle.h"
 
 #ifndef CONFIG_AP_SSID
 #define CONFIG_AP_SSID "ESP_Config"
@@ -32,67 +36,228 @@ httpd_handle_t portal_httpd = NULL;
 esp_netif_t *portal_ap_netif = NULL;
 volatile bool portal_skip_no_mqtt = false;      /*!< Flag to skip MQTT and run without it */
 
-// Simple HTML form to configure Wi‑Fi or skip MQTT
+// gzip-compressed index.html embedded by CMakeLists.txt
+extern const uint8_t index_html_gz_start[] asm("_binary_index_html_gz_start");
+extern const uint8_t index_html_gz_end[]   asm("_binary_index_html_gz_end");
+
+// ETag of the page is a content hash passed by CMakeLists.txt
+#define STR(x)  #x
+#define XSTR(x) STR(x)
+#ifndef PORTAL_INDEX_ETAG
+#define PORTAL_INDEX_ETAG dev
+#endif
+#define INDEX_ETAG "\"" XSTR(PORTAL_INDEX_ETAG) "\""
+
+// Size of chunks in which request body is received
+#define RECV_CHUNK_LEN 128
+// Receive timeouts (recv_wait_timeout each) tolerated before a stalled upload is dropped
+#define RECV_TIMEOUT_RETRIES 2
+
+// Time per scanned channel and time back on the AP channel between them, so connected
+// installers keep being served while the scan runs
+#define SCAN_CHANNEL_MS     120
+#define SCAN_HOME_DWELL_MS  30
+
+// Cached scan result, only accessed from the httpd task and before the server starts;
+// the scan itself runs in the background and only its completion is signalled by event
+static wifi_ap_record_t s_scan_records[CONFIG_PORTAL_SCAN_MAX];
+static uint16_t s_scan_cnt = 0;
+static int64_t s_scan_time_us = -1;
+static volatile bool s_scan_running = false;
+static volatile bool s_scan_done = false;
+
+// Form field filled by streaming parser; value is truncated to its buffer size
+typedef struct {
+    const char *key;
+    char *value;
+    size_t size;
+} form_field_t;
+
+// Streaming parser state for application/x-www-form-urlencoded body
+typedef struct {
+    form_field_t *fields;
+    size_t field_cnt;
+    char key[16];
+    size_t key_len;
+    form_field_t *cur;      /*!< Field receiving value, NULL if value is skipped */
+    size_t val_len;
+    bool in_value;
+    int pct_state;          /*!< Number of characters seen after '%' */
+    int pct_hi;             /*!< Decoded first hex digit */
+    char pct_raw;           /*!< First character after '%' as received */
+} form_parser_t;
+
+// Callback consuming chunk of request body
+typedef void (*body_feed_fn)(void *ctx, const char *data, size_t len);
+
+// Serve the portal page; gzip-compressed, cacheable and revalidated by ETag
 static esp_err_t root_get_handler(httpd_req_t *req) {
-    const char *html =
-        "<html><head><meta name=viewport content=\"width=device-width, initial-scale=1\"></head><body>"
-        "<h3>Wi-Fi Setup</h3>"
-        "<form method='POST' action='/save'>"
-        "SSID: <input name='ssid'><br>"
-        "Password: <input name='pass' type='password'><br>"
-        "<button type='submit'>Save</button>"
-        "</form>"
-        "<hr>"
-        "<form method='GET' action='/skip'>"
-        "<button type='submit'>Run without MQTT</button>"
-        "</form>"
-        "<p>This starts the program without WiFi and MQTT publishing setup.</p>"
-        "</body></html>";
+    char etag[32];
+    if (httpd_req_get_hdr_value_str(req, "If-None-Match", etag, sizeof(etag)) == ESP_OK &&
+        strcmp(etag, INDEX_ETAG) == 0) {
+        httpd_resp_set_status(req, "304 Not Modified");
+        httpd_resp_set_hdr(req, "ETag", INDEX_ETAG);
+        return httpd_resp_send(req, NULL, 0);
+    }
+
     httpd_resp_set_type(req, "text/html");
-    return httpd_resp_send(req, html, HTTPD_RESP_USE_STRLEN);
-}
-
-// Simple URL decoder for '+' (space) and special %HH sequences
-static void urldecode(char *s) {
-    char *src = s, *dst = s;
-    while (*src) {
-        if (*src == '+') { *dst++ = ' '; src++; }
-        else if (*src == '%' && src[1] && src[2]) {
-            int hi = src[1];
-            int lo = src[2];
-            hi = (hi >= '0' && hi <= '9') ? hi - '0' : (hi >= 'A' && hi <= 'F') ? hi - 'A' + 10 : (hi >= 'a' && hi <= 'f') ? hi - 'a' + 10 : -1;
-            lo = (lo >= '0' && lo <= '9') ? lo - '0' : (lo >= 'A' && lo <= 'F') ? lo - 'A' + 10 : (lo >= 'a' && lo <= 'f') ? lo - 'a' + 10 : -1;
-            if (hi >= 0 && lo >= 0) { *dst++ = (char)((hi << 4) | lo); src += 3; }
-            else { *dst++ = *src++; }
+    httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
+    httpd_resp_set_hdr(req, "Cache-Control", "public, max-age=" XSTR(CONFIG_PORTAL_CACHE_MAX_AGE));
+    httpd_resp_set_hdr(req, "ETag", INDEX_ETAG);
+    return httpd_resp_send(req, (const char *)index_html_gz_start, index_html_gz_end - index_html_gz_start);
+}
+
+static int hex_val(int c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+static void form_parser_init(form_parser_t *fp, form_field_t *fields, size_t field_cnt) {
+    memset(fp, 0, sizeof(*fp));
+    fp->fields = fields;
+    fp->field_cnt = field_cnt;
+}
+
+static void form_value_put(form_parser_t *fp, char c) {
+    if (fp->cur && fp->val_len + 1 < fp->cur->size) {
+        fp->cur->value[fp->val_len++] = c;
+        fp->cur->value[fp->val_len] = '\0';
+    }
+}
+
+// Finish pending '%' sequence that turned out to be invalid; keep it literally
+static void form_flush_pct(form_parser_t *fp) {
+    if (fp->pct_state >= 1) form_value_put(fp, '%');
+    if (fp->pct_state == 2) form_value_put(fp, (char)fp->pct_raw);
+    fp->pct_state = 0;
+}
+
+// Parse body chunk; key=value pairs separated by '&', values URL-decoded on the fly
+static void form_parser_feed(void *ctx, const char *data, size_t len) {
+    form_parser_t *fp = ctx;
+    for (size_t i = 0; i < len; i++) {
+        char c = data[i];
+        if (!fp->in_value) {
+            if (c == '=') {
+                fp->cur = NULL;
+                for (size_t f = 0; f < fp->field_cnt; f++) {
+                    if (fp->key_len < sizeof(fp->key) && strcmp(fp->key, fp->fields[f].key) == 0) {
+                        fp->cur = &fp->fields[f];
+                        fp->cur->value[0] = '\0';
+                    }
+                }
+                fp->val_len = 0;
+                fp->in_value = true;
+            }
+            else if (c == '&') {
+                fp->key_len = 0;
+                fp->key[0] = '\0';
+            }
+            else if (fp->key_len + 1 < sizeof(fp->key)) {
+                fp->key[fp->key_len++] = c;
+                fp->key[fp->key_len] = '\0';
+            }
+            else {
+                // Over-long key never matches any field
+                fp->key_len = sizeof(fp->key);
+            }
+            continue;
+        }
+
+        if (c == '&') {
+            form_flush_pct(fp);
+            fp->in_value = false;
+            fp->key_len = 0;
+            fp->key[0] = '\0';
+        }
+        else {
+            if (fp->pct_state != 0) {
+                int digit = hex_val(c);
+                if (digit >= 0 && fp->pct_state == 1) {
+                    fp->pct_hi = digit;
+                    fp->pct_raw = c;
+                    fp->pct_state = 2;
+                    continue;
+                }
+                if (digit >= 0) {
+                    form_value_put(fp, (char)((fp->pct_hi << 4) | digit));
+                    fp->pct_state = 0;
+                    continue;
+                }
+                // Malformed escape: the pending "%" or "%X" is kept literally and c goes
+                // through the normal path, so '%' starts a new escape and '+' is a space
+                // ("%4%41" -> "%4A", "%4+" -> "%4 ")
+                form_flush_pct(fp);
+            }
+            if (c == '%') {
+                fp->pct_state = 1;
+            }
+            else {
+                form_value_put(fp, c == '+' ? ' ' : c);
+            }
         }
-        else { *dst++ = *src++; }
     }
-    *dst = '\0';
 }
 
-// Handle POST /save: store SSID/pass in NVS and reboot
-static esp_err_t save_post_handler(httpd_req_t *req) {
-    char buf[160];
-    int received = httpd_req_recv(req, buf, sizeof(buf) - 1);
-    if (received <= 0) {
+static void form_parser_finish(form_parser_t *fp) {
+    if (fp->in_value) form_flush_pct(fp);
+}
+
+// Receive whole request body in chunks and pass them to feed
+static esp_err_t recv_body(httpd_req_t *req, body_feed_fn feed, void *ctx) {
+    char chunk[RECV_CHUNK_LEN];
+    size_t remaining = req->content_len;
+
+    if (remaining == 0) {
         httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "No data");
         return ESP_FAIL;
     }
+    if (remaining > CONFIG_PORTAL_MAX_BODY) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Request body too large");
+        return ESP_FAIL;
+    }
 
-    buf[received] = '\0';
+    int timeouts = 0;
+    while (remaining > 0) {
+        int received = httpd_req_recv(req, chunk, remaining < sizeof(chunk) ? remaining : sizeof(chunk));
+        if (received == HTTPD_SOCK_ERR_TIMEOUT) {
+            // Single httpd task: a stalled client must not block other installers
+            if (++timeouts > RECV_TIMEOUT_RETRIES) {
+                httpd_resp_send_err(req, HTTPD_408_REQ_TIMEOUT, "Request timed out");
+                return ESP_FAIL;
+            }
+            continue;
+        }
+        if (received <= 0) {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Incomplete data");
+            return ESP_FAIL;
+        }
+        feed(ctx, chunk, received);
+        remaining -= received;
+    }
+    return ESP_OK;
+}
+
+// Handle POST /save: store SSID/pass in NVS and reboot
+static esp_err_t save_post_handler(httpd_req_t *req) {
     char ssid[64] = {0}, pass[64] = {0};
-    (void)httpd_query_key_value(buf, "ssid", ssid, sizeof(ssid));
-    (void)httpd_query_key_value(buf, "pass", pass, sizeof(pass));
-    urldecode(ssid);
-    urldecode(pass);
+    form_field_t fields[] = {
+        { "ssid", ssid, sizeof(ssid) },
+        { "pass", pass, sizeof(pass) },
+    };
+    form_parser_t fp;
+    form_parser_init(&fp, fields, sizeof(fields) / sizeof(fields[0]));
+    if (recv_body(req, form_parser_feed, &fp) != ESP_OK) {
+        return ESP_FAIL;
+    }
+    form_parser_finish(&fp);
 
     // Save credentials to NVS
-    nvs_handle_t nvh;
-    if (nvs_open("wifi", NVS_READWRITE, &nvh) == ESP_OK) {
-        nvs_set_str(nvh, "ssid", ssid);
-        nvs_set_str(nvh, "pass", pass);
-        nvs_commit(nvh);
-        nvs_close(nvh);
+    if (wifi_save_creds(ssid, pass) != ESP_OK) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Storing credentials failed");
+        return ESP_FAIL;
     }
 
     httpd_resp_set_type(req, "text/html");
@@ -102,6 +267,151 @@ static esp_err_t save_post_handler(httpd_req_t *req) {
     return ESP_OK;
 }
 
+// Scan completion; records are fetched later by the httpd task which owns the cache
+static void scan_event_handler(void *arg, esp_event_base_t base, int32_t id, void *data) {
+    s_scan_done = true;
+    s_scan_running = false;
+}
+
+// Start background Wi-Fi scan on the STA interface; the attempt is timestamped even
+// when it fails so a failing scan is retried once per TTL, not on every request
+static void scan_start(void) {
+    if (s_scan_running) return;
+    s_scan_time_us = esp_timer_get_time();
+
+    // Pending STA connect (e.g. after failed connect before the portal) makes scan fail
+    esp_wifi_disconnect();
+
+    wifi_scan_config_t scan_cfg = {
+        .show_hidden = false,
+        .scan_time.active = { .min = 0, .max = SCAN_CHANNEL_MS },
+        .home_chan_dwell_time = SCAN_HOME_DWELL_MS,
+    };
+    esp_err_t err = esp_wifi_scan_start(&scan_cfg, false);
+    if (err != ESP_OK) {
+        ESP_LOGW("Portal", "Wi-Fi scan failed: %s", esp_err_to_name(err));
+        return;
+    }
+    s_scan_running = true;
+}
+
+// Take records of finished scan into the cache, strongest networks first
+static void scan_collect(void) {
+    if (!s_scan_done) return;
+    s_scan_done = false;
+
+    uint16_t cnt = CONFIG_PORTAL_SCAN_MAX;
+    if (esp_wifi_scan_get_ap_records(&cnt, s_scan_records) != ESP_OK) {
+        cnt = 0;
+    }
+    s_scan_cnt = cnt;
+}
+
+// Escape SSID for use inside JSON string
+static void json_escape(char *dst, size_t dst_len, const char *src) {
+    size_t n = 0;
+    for (; *src && n + 7 < dst_len; src++) {
+        unsigned char c = (unsigned char)*src;
+        if (c == '"' || c == '\\') {
+            dst[n++] = '\\';
+            dst[n++] = (char)c;
+        }
+        else if (c < 0x20) {
+            n += snprintf(dst + n, dst_len - n, "\\u%04x", c);
+        }
+        else {
+            dst[n++] = (char)c;
+        }
+    }
+    dst[n] = '\0';
+}
+
+// Handle GET /scan: list of nearby networks as JSON, scan result cached for CONFIG_PORTAL_SCAN_TTL_MS;
+// never waits for the scan, "Retry-After" tells the page to ask again while one is running
+static esp_err_t scan_get_handler(httpd_req_t *req) {
+    scan_collect();
+    if (s_scan_time_us < 0 || esp_timer_get_time() - s_scan_time_us > CONFIG_PORTAL_SCAN_TTL_MS * 1000LL) {
+        scan_start();
+    }
+
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+    if (s_scan_running) {
+        httpd_resp_set_hdr(req, "Retry-After", "3");
+    }
+    httpd_resp_sendstr_chunk(req, "[");
+    bool first = true;
+    for (uint16_t i = 0; i < s_scan_cnt; i++) {
+        const wifi_ap_record_t *ap = &s_scan_records[i];
+        if (ap->ssid[0] == '\0') continue;
+
+        // Records are sorted by signal strength; skip weaker duplicates of the same SSID
+        bool dup = false;
+        for (uint16_t j = 0; j < i && !dup; j++) {
+            dup = strcmp((const char *)s_scan_records[j].ssid, (const char *)ap->ssid) == 0;
+        }
+        if (dup) continue;
+
+        char ssid[7 * sizeof(ap->ssid)];
+        char entry[sizeof(ssid) + 48];
+        json_escape(ssid, sizeof(ssid), (const char *)ap->ssid);
+        snprintf(entry, sizeof(entry), "%s{\"ssid\":\"%s\",\"rssi\":%d,\"open\":%s}",
+                first ? "" : ",", ssid, ap->rssi, ap->authmode == WIFI_AUTH_OPEN ? "true" : "false");
+        httpd_resp_sendstr_chunk(req, entry);
+        first = false;
+    }
+    httpd_resp_sendstr_chunk(req, "]");
+    return httpd_resp_sendstr_chunk(req, NULL);
+}
+
+static void bundle_feed(void *ctx, const char *data, size_t len) {
+    bundle_buf_t *b = ctx;
+    if (b->len + len > BUNDLE_MAX_LEN) {
+        b->overflow = true;
+        return;
+    }
+    memcpy(b->data + b->len, data, len);
+    b->len += len;
+}
+
+// Handle POST /bundle: verify signed config bundle, store it and reboot
+static esp_err_t bundle_post_handler(httpd_req_t *req) {
+    static bundle_buf_t buf;
+    buf.len = 0;
+    buf.overflow = false;
+    if (recv_body(req, bundle_feed, &buf) != ESP_OK) {
+        return ESP_FAIL;
+    }
+    if (buf.overflow) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Bundle too large");
+        return ESP_FAIL;
+    }
+
+    esp_err_t err = bundle_apply(buf.data, buf.len);
+    if (err == ESP_ERR_INVALID_STATE || err == ESP_ERR_INVALID_CRC || err == ESP_ERR_NOT_FOUND) {
+        httpd_resp_send_err(req, HTTPD_403_FORBIDDEN, "Bundle signature rejected");
+        return ESP_FAIL;
+    }
+    if (err == ESP_ERR_INVALID_ARG) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid bundle");
+        return ESP_FAIL;
+    }
+    if (err == ESP_FAIL) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Bundle stored partially, Wi-Fi credentials missing");
+        return ESP_FAIL;
+    }
+    if (err != ESP_OK) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Storing bundle failed");
+        return ESP_FAIL;
+    }
+
+    httpd_resp_set_type(req, "text/plain");
+    httpd_resp_send(req, "OK, rebooting", HTTPD_RESP_USE_STRLEN);
+    vTaskDelay(pdMS_TO_TICKS(300));
+    esp_restart();
+    return ESP_OK;
+}
+
 // Handle GET /skip: set flag to run without MQTT
 static esp_err_t skip_get_handler(httpd_req_t *req) {
     portal_skip_no_mqtt = true;
@@ -133,15 +443,33 @@ void portal_start(void) {
     ap_cfg.ap.ssid_len = strlen((char*)ap_cfg.ap.ssid);
     ap_cfg.ap.channel = 1;
     ap_cfg.ap.authmode = WIFI_AUTH_OPEN;
-    ap_cfg.ap.max_connection = 4;
+    ap_cfg.ap.max_connection = CONFIG_PORTAL_MAX_STA;
     ap_cfg.ap.beacon_interval = 100;
 
-    esp_wifi_set_mode(WIFI_MODE_AP);
+    // STA interface stays up only for scanning; it must not try to (re)connect meanwhile
+    wifi_set_auto_connect(false);
+    esp_wifi_set_mode(WIFI_MODE_APSTA);
     esp_wifi_set_config(WIFI_IF_AP, &ap_cfg);
     esp_wifi_start();
 
+    // First scan runs while the server starts; register once as the portal can restart
+    static bool scan_handler_registered = false;
+    if (!scan_handler_registered) {
+        esp_event_handler_register(WIFI_EVENT, WIFI_EVENT_SCAN_DONE, &scan_event_handler, NULL);
+        scan_handler_registered = true;
+    }
+    scan_start();
+
     httpd_config_t conf = HTTPD_DEFAULT_CONFIG();
     conf.server_port = 80;
+    conf.core_id = task_plan_httpd.core_id;
+    conf.task_priority = task_plan_httpd.priority;
+    conf.stack_size = task_plan_httpd.stack_size;
+    conf.max_open_sockets = CONFIG_PORTAL_MAX_SOCKETS;
+    // Many installers at once: drop idle connections instead of refusing new ones
+    conf.lru_purge_enable = true;
+    conf.recv_wait_timeout = 5;
+    conf.send_wait_timeout = 5;
     httpd_start(&portal_httpd, &conf);
 
     httpd_uri_t root = { .uri = "/", .method = HTTP_GET, .handler = root_get_handler, .user_ctx = NULL };
@@ -150,6 +478,10 @@ void portal_start(void) {
     httpd_register_uri_handler(portal_httpd, &save);
     httpd_uri_t skip = { .uri = "/skip", .method = HTTP_GET, .handler = skip_get_handler, .user_ctx = NULL };
     httpd_register_uri_handler(portal_httpd, &skip);
+    httpd_uri_t scan = { .uri = "/scan", .method = HTTP_GET, .handler = scan_get_handler, .user_ctx = NULL };
+    httpd_register_uri_handler(portal_httpd, &scan);
+    httpd_uri_t bundle = { .uri = "/bundle", .method = HTTP_POST, .handler = bundle_post_handler, .user_ctx = NULL };
+    httpd_register_uri_handler(portal_httpd, &bundle);
 }
 
 // Run portal until skip flag is set; then clean up AP/server
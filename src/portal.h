@@ -11,8 +11,39 @@
 #include <stdbool.h>
 #include "esp_http_server.h"
 #include "esp_netif.h"
+#include "esp_wifi.h"
+#include "bundle.h"
 #include "u8g2.h"
 
+// Number of simultaneously open HTTP connections (each holds heap for its socket);
+// least recently used connection is closed when all are taken
+#ifndef CONFIG_PORTAL_MAX_SOCKETS
+#define CONFIG_PORTAL_MAX_SOCKETS   6
+#endif
+// Number of stations allowed on the SoftAP at once (ESP32 supports up to 10)
+#ifndef CONFIG_PORTAL_MAX_STA
+#define CONFIG_PORTAL_MAX_STA       8
+#endif
+// Largest accepted request body
+#ifndef CONFIG_PORTAL_MAX_BODY
+#define CONFIG_PORTAL_MAX_BODY      4096
+#endif
+// Browser cache lifetime of the portal page in seconds (revalidated by ETag afterwards)
+#ifndef CONFIG_PORTAL_CACHE_MAX_AGE
+#define CONFIG_PORTAL_CACHE_MAX_AGE 3600
+#endif
+// Number of networks kept from a scan and how long the result is reused
+#ifndef CONFIG_PORTAL_SCAN_MAX
+#define CONFIG_PORTAL_SCAN_MAX      16
+#endif
+#ifndef CONFIG_PORTAL_SCAN_TTL_MS
+#define CONFIG_PORTAL_SCAN_TTL_MS   30000
+#endif
+
+// Static bytes of portal.c: cached scan results and the bundle upload buffer
+#define PORTAL_STATIC_BYTES \
+    (CONFIG_PORTAL_SCAN_MAX * sizeof(wifi_ap_record_t) + sizeof(bundle_buf_t))
+
 // Handle to the running HTTP server instance in portal mode
 extern httpd_handle_t portal_httpd;
 // Netif instance for the SoftAP used by the portal
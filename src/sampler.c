@@ -0,0 +1,61 @@
+/** 
+ * Author: Jakub Lůčný (xlucnyj00)
+ * Date: 18.10.2026
+ * 
+ * VUT FIT IMP 2025
+ */
+
+#include <math.h>
+#include "sampler.h"
+
+// Initialize sampler with given limits, first interval is the fastest one
+void sampler_init(sampler_t *s, const sampler_limits_t *limits) {
+    s->limits = *limits;
+    if (s->limits.min_ms == 0) s->limits.min_ms = 1;
+    if (s->limits.max_ms < s->limits.min_ms) s->limits.max_ms = s->limits.min_ms;
+    s->interval_ms = s->limits.min_ms;
+    s->last_ms = 0;
+    s->last_t = 0.0f;
+    s->last_h = 0.0f;
+    s->have_last = false;
+}
+
+// Fast signal -> minimum interval, flat signal -> double interval up to the floor;
+// growing backlog doubles the interval unless the signal is fast, so an uplink outage
+// does not hide a rapid change
+uint32_t sampler_next_interval(sampler_t *s, float temp, float hum, uint32_t now_ms, uint32_t backlog_bytes) {
+    const sampler_limits_t *lim = &s->limits;
+    uint32_t interval = s->interval_ms;
+    bool fast = false;
+
+    if (s->have_last && now_ms != s->last_ms) {
+        float dt = fabsf(temp - s->last_t);
+        float dh = fabsf(hum - s->last_h);
+        float minutes = (float)(now_ms - s->last_ms) / 60000.0f;
+
+        float rate_t = (dt < CONFIG_SAMPLE_NOISE_T) ? 0.0f : dt / minutes;
+        float rate_h = (dh < CONFIG_SAMPLE_NOISE_H) ? 0.0f : dh / minutes;
+
+        fast = rate_t > lim->rate_t || rate_h > lim->rate_h;
+        if (fast) {
+            interval = lim->min_ms;
+        }
+        else {
+            interval *= 2;
+        }
+    }
+
+    if (!fast && backlog_bytes >= lim->backlog_high) {
+        interval = (s->interval_ms > interval ? s->interval_ms : interval) * 2;
+    }
+
+    if (interval < lim->min_ms) interval = lim->min_ms;
+    if (interval > lim->max_ms) interval = lim->max_ms;
+
+    s->interval_ms = interval;
+    s->last_ms = now_ms;
+    s->last_t = temp;
+    s->last_h = hum;
+    s->have_last = true;
+    return interval;
+}
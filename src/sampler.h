@@ -0,0 +1,73 @@
+/** 
+ * Author: Jakub Lůčný (xlucnyj00)
+ * Date: 18.10.2026
+ * 
+ * VUT FIT IMP 2025
+ */
+
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Fastest sample interval, used while temperature or humidity change quickly
+#ifndef CONFIG_SAMPLE_MIN_MS
+#define CONFIG_SAMPLE_MIN_MS        2000
+#endif
+// Slow floor reached by exponential back-off while the signal is flat
+#ifndef CONFIG_SAMPLE_MAX_MS
+#define CONFIG_SAMPLE_MAX_MS        60000
+#endif
+// Rate of change (per minute) above which sampling switches to the fastest interval
+#ifndef CONFIG_SAMPLE_RATE_T
+#define CONFIG_SAMPLE_RATE_T        0.5f
+#endif
+#ifndef CONFIG_SAMPLE_RATE_H
+#define CONFIG_SAMPLE_RATE_H        2.0f
+#endif
+// Changes below sensor noise are treated as no change
+#ifndef CONFIG_SAMPLE_NOISE_T
+#define CONFIG_SAMPLE_NOISE_T       0.05f
+#endif
+#ifndef CONFIG_SAMPLE_NOISE_H
+#define CONFIG_SAMPLE_NOISE_H       0.3f
+#endif
+// Uplink backlog (bytes queued or dropped, see mqtt_backlog_bytes) above which sampling slows down
+#ifndef CONFIG_SAMPLE_BACKLOG_HIGH
+#define CONFIG_SAMPLE_BACKLOG_HIGH  2048
+#endif
+
+// Sampler limits, runtime configurable (see app_config.h)
+typedef struct {
+    uint32_t min_ms;        /*!< Fastest interval */
+    uint32_t max_ms;        /*!< Slow floor */
+    float rate_t;           /*!< Temperature change per minute switching to fastest interval */
+    float rate_h;           /*!< Humidity change per minute switching to fastest interval */
+    uint32_t backlog_high;  /*!< Uplink backlog in bytes which slows sampling down */
+} sampler_limits_t;
+
+#define SAMPLER_LIMITS_DEFAULT { \
+    .min_ms = CONFIG_SAMPLE_MIN_MS, \
+    .max_ms = CONFIG_SAMPLE_MAX_MS, \
+    .rate_t = CONFIG_SAMPLE_RATE_T, \
+    .rate_h = CONFIG_SAMPLE_RATE_H, \
+    .backlog_high = CONFIG_SAMPLE_BACKLOG_HIGH, \
+}
+
+// Adaptive sampler state; independent of FreeRTOS so it can run on host too
+typedef struct {
+    sampler_limits_t limits;
+    uint32_t interval_ms;   /*!< Interval chosen by the last call */
+    uint32_t last_ms;       /*!< Time of the previous sample */
+    float last_t;
+    float last_h;
+    bool have_last;
+} sampler_t;
+
+// Initialize sampler with given limits, first interval is the fastest one
+void sampler_init(sampler_t *s, const sampler_limits_t *limits);
+// Compute interval until next sample from new values, their time and uplink backlog in bytes
+uint32_t sampler_next_interval(sampler_t *s, float temp, float hum, uint32_t now_ms, uint32_t backlog_bytes);
+
+#endif // SAMPLER_H
@@ -6,50 +6,81 @@
  */
 
 #include "freertos/FreeRTOS.h"
+#include "esp_log.h"
 #include "sensor.h"
 #include "i2c_bus.h"
-#include "driver/i2c_master.h"
 
 #define SHT31_ADDR 0x44
 
-// I2C device handle for the SHT31 sensor
-static i2c_master_dev_handle_t s_i2c_sht31 = NULL;
+// SHT3x words are followed by CRC-8, polynomial 0x31, initial value 0xFF
+static uint8_t sht31_crc(const uint8_t *data, int len) {
+    uint8_t crc = 0xFF;
+    for (int i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x31) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+// Probe by reading the status register; CRC catches corrupted bits at high clock
+static esp_err_t sht31_probe(i2c_dev_id_t dev) {
+    const uint8_t cmd[2] = { 0xF3, 0x2D };
+    uint8_t status[3];
+
+    esp_err_t err = i2c_bus_transmit(dev, cmd, sizeof(cmd));
+    if (err == ESP_OK) {
+        err = i2c_bus_receive(dev, status, sizeof(status));
+    }
+    if (err == ESP_OK && sht31_crc(status, 2) != status[2]) {
+        err = ESP_ERR_INVALID_CRC;
+    }
+    return err;
+}
 
-// Add SHT31 device to the I2C bus
+// Add SHT31 device to the I2C bus at the fastest speed passing the probe
 void sensor_init(void) {
-    i2c_device_config_t sht_cfg = {
-        .dev_addr_length = I2C_ADDR_BIT_LEN_7,
-        .device_address = SHT31_ADDR,
-        .scl_speed_hz = CONFIG_I2C_MASTER_FREQUENCY,
-    };
-    i2c_master_bus_add_device(g_i2c_bus, &sht_cfg, &s_i2c_sht31);
+    esp_err_t err = i2c_bus_add_device(I2C_DEV_SENSOR, SHT31_ADDR, CONFIG_I2C_SENSOR_FREQUENCY, sht31_probe);
+    if (err != ESP_OK) {
+        ESP_LOGE("Sensor", "SHT31 not responding: %s", esp_err_to_name(err));
+    }
 }
 
-// Trigger measurement and convert raw values to °C and % humidity
-void sensor_read(float *temp_c, float *rh) {
+// Trigger measurement and read raw temperature and humidity words
+bool sensor_read_raw(uint16_t *st, uint16_t *srh) {
     const uint8_t cmd[2] = { 0x24, 0x00 };
 
-    if (!s_i2c_sht31) {
-        *temp_c = 0; *rh = 0;
-        return;
-    }
-
-    if (i2c_master_transmit(s_i2c_sht31, cmd, sizeof(cmd), 1000) != ESP_OK) {
-        *temp_c = 0; *rh = 0;
-        return;
+    if (i2c_bus_transmit(I2C_DEV_SENSOR, cmd, sizeof(cmd)) != ESP_OK) {
+        return false;
     }
 
     vTaskDelay(pdMS_TO_TICKS(30));
     uint8_t raw[6] = {0};
 
-    if (i2c_master_receive(s_i2c_sht31, raw, sizeof(raw), 1000) != ESP_OK) {
-        *temp_c = 0; *rh = 0;
-        return;
+    if (i2c_bus_receive(I2C_DEV_SENSOR, raw, sizeof(raw)) != ESP_OK) {
+        return false;
     }
+    if (sht31_crc(&raw[0], 2) != raw[2] || sht31_crc(&raw[3], 2) != raw[5]) {
+        ESP_LOGW("Sensor", "CRC mismatch");
+        return false;
+    }
+    *st = ((uint16_t)raw[0] << 8) | raw[1];
+    *srh = ((uint16_t)raw[3] << 8) | raw[4];
 
-    uint16_t st = ((uint16_t)raw[0] << 8) | raw[1];
-    uint16_t srh = ((uint16_t)raw[3] << 8) | raw[4];
+#if CONFIG_SENSOR_TRACE_RAW
+    ESP_LOGI("Sensor", "raw %lu %04x %04x",
+            (unsigned long)(xTaskGetTickCount() * portTICK_PERIOD_MS), *st, *srh);
+#endif
+    return true;
+}
 
-    *temp_c = -45.0f + 175.0f * ((float)st / 65535.0f);
-    *rh = 100.0f * ((float)srh / 65535.0f);
+// Read sensor and convert raw values to °C and % humidity; outputs untouched on failure
+bool sensor_read(float *temp_c, float *rh) {
+    uint16_t st, srh;
+    if (!sensor_read_raw(&st, &srh)) {
+        return false;
+    }
+    sensor_convert(st, srh, temp_c, rh);
+    return true;
 }
@@ -8,9 +8,31 @@
 #ifndef SENSOR_H
 #define SENSOR_H
 
+#include <stdbool.h>
+#include <stdint.h>
+
+// Log every raw reading as "raw <ms> <st> <srh>" for recording replay traces (tools/replay)
+#ifndef CONFIG_SENSOR_TRACE_RAW
+#define CONFIG_SENSOR_TRACE_RAW 0
+#endif
+
+// Single measurement handed over from sampler to display task
+typedef struct {
+    float temp;
+    float hum;
+} measurement_t;
+
 // Initialize the SHT31 device on the I2C bus
 void sensor_init(void);
-// Read temperature (°C) and humidity (%) from SHT31
-void sensor_read(float *temp_c, float *rh);
+// Read raw 16-bit temperature and humidity words from SHT31; returns false on bus error
+bool sensor_read_raw(uint16_t *st, uint16_t *srh);
+// Read temperature (°C) and humidity (%) from SHT31; returns false on bus or CRC error
+bool sensor_read(float *temp_c, float *rh);
+
+// Convert raw SHT31 words to °C and % humidity; shared with the host replay tool
+static inline void sensor_convert(uint16_t st, uint16_t srh, float *temp_c, float *rh) {
+    *temp_c = -45.0f + 175.0f * ((float)st / 65535.0f);
+    *rh = 100.0f * ((float)srh / 65535.0f);
+}
 
 #endif // SENSOR_H
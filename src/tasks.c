@@ -0,0 +1,105 @@
+/** 
+ * Author: Jakub Lůčný (xlucnyj00)
+ * Date: 18.10.2026
+ * 
+ * VUT FIT IMP 2025
+ */
+
+#include "tasks.h"
+#include "esp_log.h"
+#include "memstat.h"
+#include "display_policy.h"
+#include "i2c_bus.h"
+
+#include "sdkconfig.h"
+
+#define TAG "Tasks"
+
+// Wi-Fi, lwIP and esp-mqtt cores come from sdkconfig only, the plan cannot move them
+#if CONFIG_TASK_CORE_NET == 0 && (defined(CONFIG_ESP_WIFI_TASK_PINNED_TO_CORE_1) || \
+        defined(CONFIG_LWIP_TCPIP_TASK_AFFINITY_CPU1) || defined(CONFIG_MQTT_USE_CORE_1))
+#error "CONFIG_TASK_CORE_NET is 0 but Wi-Fi, lwIP or MQTT task is pinned to core 1 in sdkconfig"
+#endif
+#if CONFIG_TASK_CORE_NET == 1 && (defined(CONFIG_ESP_WIFI_TASK_PINNED_TO_CORE_0) || \
+        defined(CONFIG_LWIP_TCPIP_TASK_AFFINITY_CPU0) || defined(CONFIG_MQTT_USE_CORE_0))
+#error "CONFIG_TASK_CORE_NET is 1 but Wi-Fi, lwIP or MQTT task is pinned to core 0 in sdkconfig"
+#endif
+// Main task allocates the I2C interrupt, it has to run on the application core
+#if (CONFIG_TASK_CORE_APP == 0 && defined(CONFIG_ESP_MAIN_TASK_AFFINITY_CPU1)) || \
+    (CONFIG_TASK_CORE_APP == 1 && defined(CONFIG_ESP_MAIN_TASK_AFFINITY_CPU0))
+#error "CONFIG_TASK_CORE_APP does not match CONFIG_ESP_MAIN_TASK_AFFINITY in sdkconfig"
+#endif
+
+const task_placement_t task_plan[APP_TASK_COUNT] = {
+    [APP_TASK_SAMPLER] = { "sampler", CONFIG_TASK_CORE_APP, CONFIG_TASK_PRIO_SAMPLER, CONFIG_TASK_STACK_SAMPLER },
+    [APP_TASK_DISPLAY] = { "display", CONFIG_TASK_CORE_APP, CONFIG_TASK_PRIO_DISPLAY, CONFIG_TASK_STACK_DISPLAY },
+    [APP_TASK_MONITOR] = { "monitor", CONFIG_TASK_CORE_NET, CONFIG_TASK_PRIO_MONITOR, CONFIG_TASK_STACK_MONITOR },
+};
+
+const task_placement_t task_plan_mqtt  = { "mqtt_task", CONFIG_TASK_CORE_NET, CONFIG_TASK_PRIO_MQTT,  CONFIG_TASK_STACK_MQTT };
+const task_placement_t task_plan_httpd = { "httpd",     CONFIG_TASK_CORE_NET, CONFIG_TASK_PRIO_HTTPD, CONFIG_TASK_STACK_HTTPD };
+
+// Statically allocated stacks and control blocks of application tasks
+static StackType_t s_stack_sampler[CONFIG_TASK_STACK_SAMPLER];
+static StackType_t s_stack_display[CONFIG_TASK_STACK_DISPLAY];
+static StackType_t s_stack_monitor[CONFIG_TASK_STACK_MONITOR];
+static StackType_t *const s_stacks[APP_TASK_COUNT] = {
+    [APP_TASK_SAMPLER] = s_stack_sampler,
+    [APP_TASK_DISPLAY] = s_stack_display,
+    [APP_TASK_MONITOR] = s_stack_monitor,
+};
+static StaticTask_t s_tcbs[APP_TASK_COUNT];
+static TaskHandle_t s_handles[APP_TASK_COUNT];
+
+// Create application task on its static stack, pinned according to the plan
+TaskHandle_t tasks_start(app_task_t id, TaskFunction_t fn, void *arg) {
+    const task_placement_t *p = &task_plan[id];
+    TaskHandle_t handle = xTaskCreateStaticPinnedToCore(fn, p->name, p->stack_size, arg,
+            p->priority, s_stacks[id], &s_tcbs[id], p->core_id);
+    if (!handle) {
+        ESP_LOGE(TAG, "Failed to start task %s", p->name);
+    }
+    s_handles[id] = handle;
+    return handle;
+}
+
+// Log the placement table followed by the FreeRTOS runtime statistics
+void tasks_report_runtime(void) {
+    static char stats[RUNTIME_STATS_BUF_LEN];
+
+    for (int i = 0; i < APP_TASK_COUNT; i++) {
+        // High watermark is the least amount of stack left unused since task start
+        unsigned long unused = s_handles[i] ? (unsigned long)uxTaskGetStackHighWaterMark(s_handles[i]) : 0;
+        ESP_LOGI(TAG, "%-10s core=%d prio=%u stack=%lu unused=%lu",
+                task_plan[i].name, (int)task_plan[i].core_id,
+                (unsigned)task_plan[i].priority, (unsigned long)task_plan[i].stack_size, unused);
+    }
+
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS && CONFIG_FREERTOS_USE_STATS_FORMATTING_FUNCTIONS
+    // Columns: task name, absolute run time, share of total CPU time since boot;
+    // IDLE1 share tells how much headroom the application core has left
+    vTaskGetRunTimeStats(stats);
+    ESP_LOGI(TAG, "Runtime stats:\n%s", stats);
+#else
+    (void)stats;
+    ESP_LOGW(TAG, "Runtime stats disabled in sdkconfig");
+#endif
+}
+
+// Periodically log runtime and memory report
+static void monitor_task(void *arg) {
+    while (1) {
+        tasks_report_runtime();
+        memstat_report();
+        display_policy_report();
+        i2c_bus_report();
+        vTaskDelay(pdMS_TO_TICKS(CONFIG_TASK_STATS_PERIOD_MS));
+    }
+}
+
+// Start monitor task unless reporting is disabled
+void tasks_start_monitor(void) {
+    if (CONFIG_TASK_STATS_PERIOD_MS > 0) {
+        tasks_start(APP_TASK_MONITOR, monitor_task, NULL);
+    }
+}
@@ -0,0 +1,108 @@
+/** 
+ * Author: Jakub Lůčný (xlucnyj00)
+ * Date: 18.10.2026
+ * 
+ * VUT FIT IMP 2025
+ */
+
+#ifndef TASKS_H
+#define TASKS_H
+
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+/* Task placement plan
+    core 0 (PRO) - network stack: Wi-Fi, lwIP, esp-mqtt and the portal HTTP server
+    core 1 (APP) - sampling, rendering and the I2C transport
+    Wi-Fi, lwIP and MQTT cores are selected in sdkconfig.defaults, the main task
+    is pinned to core 1 there too so the I2C bus interrupt is allocated on core 1.
+    Changing the cores here requires the same change there, tasks.c checks both agree.
+*/
+#ifndef CONFIG_TASK_CORE_NET
+#define CONFIG_TASK_CORE_NET        0
+#endif
+#ifndef CONFIG_TASK_CORE_APP
+#define CONFIG_TASK_CORE_APP        1
+#endif
+
+// Task priorities (Wi-Fi and lwIP keep their ESP-IDF defaults of 23 and 18)
+#ifndef CONFIG_TASK_PRIO_SAMPLER
+#define CONFIG_TASK_PRIO_SAMPLER    6
+#endif
+#ifndef CONFIG_TASK_PRIO_DISPLAY
+#define CONFIG_TASK_PRIO_DISPLAY    3
+#endif
+#ifndef CONFIG_TASK_PRIO_MONITOR
+#define CONFIG_TASK_PRIO_MONITOR    1
+#endif
+#ifndef CONFIG_TASK_PRIO_MQTT
+#define CONFIG_TASK_PRIO_MQTT       5
+#endif
+#ifndef CONFIG_TASK_PRIO_HTTPD
+#define CONFIG_TASK_PRIO_HTTPD      4
+#endif
+
+// Task stack sizes in bytes
+#ifndef CONFIG_TASK_STACK_SAMPLER
+#define CONFIG_TASK_STACK_SAMPLER   4096
+#endif
+#ifndef CONFIG_TASK_STACK_DISPLAY
+#define CONFIG_TASK_STACK_DISPLAY   4096
+#endif
+#ifndef CONFIG_TASK_STACK_MONITOR
+#define CONFIG_TASK_STACK_MONITOR   3072
+#endif
+#ifndef CONFIG_TASK_STACK_MQTT
+#define CONFIG_TASK_STACK_MQTT      6144
+#endif
+#ifndef CONFIG_TASK_STACK_HTTPD
+#define CONFIG_TASK_STACK_HTTPD     4096
+#endif
+
+// Bytes of statically allocated stacks of application tasks
+#define TASKS_STATIC_STACK_BYTES \
+    (CONFIG_TASK_STACK_SAMPLER + CONFIG_TASK_STACK_DISPLAY + CONFIG_TASK_STACK_MONITOR)
+
+// Size of the text buffer filled by vTaskGetRunTimeStats (~40 bytes per task)
+#define RUNTIME_STATS_BUF_LEN 1536
+
+// Static bytes of tasks.c: stacks, task control blocks and runtime statistics text
+#define TASKS_STATIC_BYTES \
+    (TASKS_STATIC_STACK_BYTES + APP_TASK_COUNT * sizeof(StaticTask_t) + RUNTIME_STATS_BUF_LEN)
+
+// Period of the runtime statistics and memory report (0 disables the monitor task)
+#ifndef CONFIG_TASK_STATS_PERIOD_MS
+#define CONFIG_TASK_STATS_PERIOD_MS 60000
+#endif
+
+// Application tasks with statically allocated stacks
+typedef enum {
+    APP_TASK_SAMPLER = 0,
+    APP_TASK_DISPLAY,
+    APP_TASK_MONITOR,
+    APP_TASK_COUNT
+} app_task_t;
+
+// Placement of a single task: core, priority and stack size
+typedef struct {
+    const char *name;
+    BaseType_t core_id;
+    UBaseType_t priority;
+    uint32_t stack_size;
+} task_placement_t;
+
+// Placement of application tasks, indexed by app_task_t
+extern const task_placement_t task_plan[APP_TASK_COUNT];
+// Placement of tasks created by ESP-IDF components
+extern const task_placement_t task_plan_mqtt;
+extern const task_placement_t task_plan_httpd;
+
+// Create application task on its statically allocated stack and pinned core
+TaskHandle_t tasks_start(app_task_t id, TaskFunction_t fn, void *arg);
+// Start low priority task periodically logging the runtime, memory, display and I2C report
+void tasks_start_monitor(void);
+// Log placement table, stack high watermarks and per-task CPU usage
+void tasks_report_runtime(void);
+
+#endif // TASKS_H
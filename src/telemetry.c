@@ -0,0 +1,78 @@
+/** 
+ * Author: Jakub Lůčný (xlucnyj00)
+ * Date: 18.10.2026
+ * 
+ * VUT FIT IMP 2025
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "telemetry.h"
+
+static void agg_reset(telemetry_agg_t *a, uint32_t now_ms) {
+    memset(a, 0, sizeof(*a));
+    a->start_ms = now_ms;
+}
+
+static void agg_add(telemetry_agg_t *a, float temp, float hum) {
+    if (a->count == 0) {
+        a->t_min = a->t_max = temp;
+        a->h_min = a->h_max = hum;
+    }
+    a->t_sum += temp;
+    a->h_sum += hum;
+    if (temp < a->t_min) a->t_min = temp;
+    if (temp > a->t_max) a->t_max = temp;
+    if (hum < a->h_min) a->h_min = hum;
+    if (hum > a->h_max) a->h_max = hum;
+    a->count++;
+}
+
+static telemetry_msg_t *msg_init(telemetry_msg_t *m, const telemetry_t *t, const char *sub, int qos, int retain) {
+    snprintf(m->topic, sizeof(m->topic), "%s/%s", t->base, sub);
+    m->qos = qos;
+    m->retain = retain;
+    return m;
+}
+
+// Initialize telemetry with base topic of this device
+void telemetry_init(telemetry_t *t, const char *base_topic, uint32_t slow_period_ms, uint32_t now_ms) {
+    snprintf(t->base, sizeof(t->base), "%s", base_topic);
+    t->slow_period_ms = slow_period_ms;
+    agg_reset(&t->agg, now_ms);
+}
+
+// Build fast, latest and (once per period) slow messages for one sample
+int telemetry_on_sample(telemetry_t *t, float temp, float hum, uint32_t interval_ms, uint32_t now_ms,
+                        telemetry_msg_t *out, int max_out) {
+    int n = 0;
+
+    if (n < max_out) {
+        telemetry_msg_t *m = msg_init(&out[n++], t, "fast", 0, 0);
+        snprintf(m->payload, sizeof(m->payload), "{\"temp_c\":%.2f,\"hum\":%.2f,\"interval_ms\":%lu}",
+                temp, hum, (unsigned long)interval_ms);
+    }
+    if (n < max_out) {
+        telemetry_msg_t *m = msg_init(&out[n++], t, "latest", 0, 1);
+        snprintf(m->payload, sizeof(m->payload), "{\"t\":%.2f,\"h\":%.2f}", temp, hum);
+    }
+
+    agg_add(&t->agg, temp, hum);
+    if (now_ms - t->agg.start_ms >= t->slow_period_ms && n < max_out) {
+        const telemetry_agg_t *a = &t->agg;
+        telemetry_msg_t *m = msg_init(&out[n++], t, "slow", 1, 0);
+        snprintf(m->payload, sizeof(m->payload),
+                "{\"n\":%lu,\"period_ms\":%lu,\"t_avg\":%.2f,\"t_min\":%.2f,\"t_max\":%.2f,"
+                "\"h_avg\":%.2f,\"h_min\":%.2f,\"h_max\":%.2f}",
+                (unsigned long)a->count, (unsigned long)(now_ms - a->start_ms),
+                a->t_sum / a->count, a->t_min, a->t_max,
+                a->h_sum / a->count, a->h_min, a->h_max);
+        agg_reset(&t->agg, now_ms);
+    }
+    return n;
+}
+
+// Build status topic for given base topic
+void telemetry_status_topic(const char *base_topic, char *out, int out_len) {
+    snprintf(out, out_len, "%s/status", base_topic);
+}
@@ -0,0 +1,62 @@
+/** 
+ * Author: Jakub Lůčný (xlucnyj00)
+ * Date: 18.10.2026
+ * 
+ * VUT FIT IMP 2025
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+
+/* Per-device topic hierarchy below base topic (e.g. meteostanice/<mac>):
+    <base>/fast    every sample, QoS 0
+    <base>/latest  compact last value, retained, for instant dashboard start
+    <base>/slow    min/avg/max aggregate every CONFIG_MQTT_SLOW_PERIOD_MS, QoS 1
+    <base>/status  "online"/"offline" (Last Will), retained
+*/
+
+// Aggregation period of the low-rate topic
+#ifndef CONFIG_MQTT_SLOW_PERIOD_MS
+#define CONFIG_MQTT_SLOW_PERIOD_MS  300000
+#endif
+
+#define TELEMETRY_TOPIC_MAX     128
+#define TELEMETRY_PAYLOAD_MAX   160
+// Messages produced by a single sample: fast, latest and possibly slow
+#define TELEMETRY_MAX_MSGS      3
+// Statically allocated message buffers of the sampler task
+#define TELEMETRY_STATIC_BYTES  (TELEMETRY_MAX_MSGS * sizeof(telemetry_msg_t))
+
+typedef struct {
+    char topic[TELEMETRY_TOPIC_MAX];
+    char payload[TELEMETRY_PAYLOAD_MAX];
+    int qos;
+    int retain;
+} telemetry_msg_t;
+
+// Running aggregate for the low-rate topic
+typedef struct {
+    uint32_t start_ms;
+    uint32_t count;
+    float t_sum, t_min, t_max;
+    float h_sum, h_min, h_max;
+} telemetry_agg_t;
+
+// Telemetry state; independent of FreeRTOS and esp-mqtt so it can run on host too
+typedef struct {
+    char base[TELEMETRY_TOPIC_MAX - 8];
+    uint32_t slow_period_ms;
+    telemetry_agg_t agg;
+} telemetry_t;
+
+// Initialize telemetry with base topic of this device
+void telemetry_init(telemetry_t *t, const char *base_topic, uint32_t slow_period_ms, uint32_t now_ms);
+// Build messages for one sample; returns number of messages written to out
+int telemetry_on_sample(telemetry_t *t, float temp, float hum, uint32_t interval_ms, uint32_t now_ms,
+                        telemetry_msg_t *out, int max_out);
+// Build status topic for given base topic
+void telemetry_status_topic(const char *base_topic, char *out, int out_len);
+
+#endif // TELEMETRY_H
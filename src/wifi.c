@@ -23,18 +23,20 @@
 
 // Event group signaling Wi‑Fi connection state
 EventGroupHandle_t wifi_event_group = NULL;
+static StaticEventGroup_t wifi_event_group_buf;
 static const int WIFI_CONNECTED_BIT = BIT0;
+static volatile bool s_auto_connect = true;
 
 // Handle Wi‑Fi and IP events; sets/clears connection bit accordingly
 static void wifi_event_handler(void *arg, esp_event_base_t base, int32_t id, void *data) {
     if (base == WIFI_EVENT) {
         switch (id) {
             case WIFI_EVENT_STA_START:
-                esp_wifi_connect();
+                if (s_auto_connect) esp_wifi_connect();
                 break;
             case WIFI_EVENT_STA_DISCONNECTED:
                 xEventGroupClearBits(wifi_event_group, WIFI_CONNECTED_BIT);
-                esp_wifi_connect();
+                if (s_auto_connect) esp_wifi_connect();
                 break;
             default:
                 break;
@@ -55,7 +57,7 @@ void nvs_init(void) {
 
 // Initialize Wi‑Fi in STA mode and register event handlers
 void wifi_sta_init(void) {
-    wifi_event_group = xEventGroupCreate();
+    wifi_event_group = xEventGroupCreateStatic(&wifi_event_group_buf);
 
     ESP_ERROR_CHECK(esp_netif_init());
 
@@ -69,6 +71,11 @@ void wifi_sta_init(void) {
     esp_event_handler_register(IP_EVENT, IP_EVENT_STA_GOT_IP, &wifi_event_handler, NULL);
 }
 
+// Enable/disable automatic (re)connect of the STA interface
+void wifi_set_auto_connect(bool enable) {
+    s_auto_connect = enable;
+}
+
 // Load SSID/password from NVS into provided buffers; returns true on success
 bool wifi_load_creds(char *out_ssid, size_t ssid_len, char *out_pass, size_t pass_len) {
     nvs_handle_t nvh;
@@ -84,3 +91,17 @@ bool wifi_load_creds(char *out_ssid, size_t ssid_len, char *out_pass, size_t pas
     nvs_close(nvh);
     return (er1 == ESP_OK && er2 == ESP_OK && out_ssid[0] != '\0');
 }
+
+// Store SSID/password in NVS, used on next boot
+esp_err_t wifi_save_creds(const char *ssid, const char *pass) {
+    nvs_handle_t nvh;
+    esp_err_t err = nvs_open("wifi", NVS_READWRITE, &nvh);
+    if (err != ESP_OK) {
+        return err;
+    }
+    if (err == ESP_OK) err = nvs_set_str(nvh, "ssid", ssid);
+    if (err == ESP_OK) err = nvs_set_str(nvh, "pass", pass);
+    if (err == ESP_OK) err = nvs_commit(nvh);
+    nvs_close(nvh);
+    return err;
+}
@@ -17,6 +17,10 @@ extern EventGroupHandle_t wifi_event_group;
 void nvs_init(void);
 // Initialize Wi‑Fi in STA mode
 void wifi_sta_init(void);
+// Enable/disable automatic (re)connect of the STA interface, e.g. while portal scans networks
+void wifi_set_auto_connect(bool enable);
+// Store SSID/password in NVS
+esp_err_t wifi_save_creds(const char *ssid, const char *pass);
 // Load stored SSID/password from NVS; returns true if available
 bool wifi_load_creds(char *out_ssid, size_t ssid_len, char *out_pass, size_t pass_len);
 
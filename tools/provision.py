@@ -0,0 +1,134 @@
+#!/usr/bin/env python3
+"""
+Author: Jakub Lůčný (xlucnyj00)
+Date: 18.10.2026
+
+VUT FIT IMP 2025
+
+Bulk provisioning of meteostations through their configuration portal.
+
+  sign  - create signed config bundle from a key=value file
+  push  - POST bundle to many portals in parallel
+
+Every unit in portal mode is reachable at 192.168.4.1 on its own SoftAP,
+so parallel pushes need one Wi-Fi interface per unit. A target is given as
+IFACE[:SSID]; with SSID the interface is first joined to that AP using
+nmcli, then the request is bound to the interface (SO_BINDTODEVICE, root).
+A plain URL target is pushed as is.
+
+Examples:
+  provision.py sign --key-file key.txt site.conf > site.bundle
+  provision.py push site.bundle wlan1:ESP_Config-1A2B wlan2:ESP_Config-3C4D
+"""
+
+import argparse
+import concurrent.futures
+import hashlib
+import hmac
+import http.client
+import socket
+import subprocess
+import sys
+import time
+
+PORTAL_HOST = "192.168.4.1"
+BUNDLE_MAX_LEN = 1024   # must match BUNDLE_MAX_LEN in src/bundle.h
+
+
+def sign(body: bytes, key: bytes) -> bytes:
+    """Append signature line; HMAC-SHA256 covers every byte before it."""
+    if not body.endswith(b"\n"):
+        body += b"\n"
+    sig = hmac.new(key, body, hashlib.sha256).hexdigest()
+    return body + b"sig=" + sig.encode() + b"\n"
+
+
+class BoundConnection(http.client.HTTPConnection):
+    """HTTP connection whose socket is bound to a network interface."""
+
+    def __init__(self, host, iface, **kwargs):
+        super().__init__(host, **kwargs)
+        self.iface = iface
+
+    def connect(self):
+        self.sock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        self.sock.setsockopt(socket.SOL_SOCKET, socket.SO_BINDTODEVICE, self.iface.encode())
+        self.sock.settimeout(self.timeout)
+        self.sock.connect((self.host, self.port))
+
+
+def push_one(target: str, bundle: bytes, timeout: float):
+    start = time.monotonic()
+    if target.startswith("http://"):
+        host = target[len("http://"):].split("/")[0]
+        conn = http.client.HTTPConnection(host, timeout=timeout)
+    else:
+        iface, _, ssid = target.partition(":")
+        if ssid:
+            subprocess.run(["nmcli", "device", "wifi", "connect", ssid, "ifname", iface],
+                           check=True, capture_output=True, timeout=timeout)
+        conn = BoundConnection(PORTAL_HOST, iface, timeout=timeout)
+
+    try:
+        conn.request("POST", "/bundle", body=bundle, headers={"Content-Type": "text/plain"})
+        resp = conn.getresponse()
+        text = resp.read().decode(errors="replace").strip()
+        ok = resp.status == 200
+    finally:
+        conn.close()
+    return ok, text, time.monotonic() - start
+
+
+def cmd_sign(args):
+    key = open(args.key_file, "rb").read().strip()
+    body = open(args.config, "rb").read()
+    bundle = sign(body, key)
+    if len(bundle) > BUNDLE_MAX_LEN:
+        sys.exit(f"bundle has {len(bundle)} bytes, limit is {BUNDLE_MAX_LEN}")
+    sys.stdout.buffer.write(bundle)
+
+
+def cmd_push(args):
+    bundle = open(args.bundle, "rb").read()
+    start = time.monotonic()
+    failed = 0
+    with concurrent.futures.ThreadPoolExecutor(max_workers=args.jobs) as pool:
+        futures = {pool.submit(push_one, t, bundle, args.timeout): t for t in args.targets}
+        for fut in concurrent.futures.as_completed(futures):
+            target = futures[fut]
+            try:
+                ok, text, took = fut.result()
+            except Exception as exc:  # report and continue with other units
+                ok, text, took = False, str(exc), 0.0
+            failed += not ok
+            print(f"{'OK  ' if ok else 'FAIL'} {target:32} {took:6.2f}s  {text}")
+
+    total = time.monotonic() - start
+    count = len(args.targets)
+    print(f"{count - failed}/{count} units provisioned in {total:.2f}s "
+          f"({total / max(count, 1):.2f}s per unit)")
+    sys.exit(1 if failed else 0)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = parser.add_subparsers(dest="cmd", required=True)
+
+    p = sub.add_parser("sign", help="create signed bundle")
+    p.add_argument("--key-file", required=True, help="file with CONFIG_BUNDLE_KEY value")
+    p.add_argument("config", help="key=value file (ssid, pass, broker, topic_base, sample_min_ms, ...)")
+    p.set_defaults(func=cmd_sign)
+
+    p = sub.add_parser("push", help="push bundle to portals in parallel")
+    p.add_argument("bundle")
+    p.add_argument("targets", nargs="+", help="IFACE[:SSID] or http://host")
+    p.add_argument("-j", "--jobs", type=int, default=16)
+    p.add_argument("--timeout", type=float, default=30.0)
+    p.set_defaults(func=cmd_push)
+
+    args = parser.parse_args()
+    args.func(args)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,272 @@
+/** 
+ * Author: Jakub Lůčný (xlucnyj00)
+ * Date: 18.10.2026
+ * 
+ * VUT FIT IMP 2025
+ */
+
+/* Host replay of recorded SHT31 traces through the sampling and telemetry pipeline
+
+    Trace is recorded by building the firmware with CONFIG_SENSOR_TRACE_RAW=1, every
+    reading is then logged as "raw <ms> <st> <srh>" (st, srh hex). Log lines may keep
+    their ESP_LOG prefix, lines without "raw " are read as bare "<ms> <st> <srh>",
+    everything else and lines starting with '#' are skipped.
+
+    The trace stands in for sensor_read: at each virtual sample time the last record
+    at or before that time is converted by sensor_convert and fed to the same
+    sampler_next_interval / telemetry_on_sample code as on the device. Virtual clock
+    jumps straight to the next sample, so the replay runs as fast as the host allows.
+    Uplink is modelled like mqtt_backlog_bytes sees it on a connected unit: only QoS > 0
+    messages wait in the esp-mqtt outbox, which is drained at --uplink-bps (0 = unlimited).
+
+    Build from repository root:
+        cc -O2 -I src tools/replay/replay.c src/sampler.c src/telemetry.c -lm -o replay
+    Run:
+        ./replay trace.log -o messages.txt
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "sensor.h"
+#include "sampler.h"
+#include "telemetry.h"
+
+// MQTT PUBLISH overhead: fixed header (up to 3 B for payloads below 2 MB) and topic length
+#define MQTT_PUBLISH_OVERHEAD   5
+// Packet identifier of QoS 1/2 messages
+#define MQTT_PACKET_ID_LEN      2
+
+typedef struct {
+    uint32_t ms;
+    uint16_t st;
+    uint16_t srh;
+} trace_rec_t;
+
+typedef struct {
+    trace_rec_t *recs;
+    size_t count;
+    size_t cap;
+} trace_t;
+
+typedef struct {
+    unsigned long samples;
+    unsigned long messages;
+    unsigned long long bytes_out;
+    double proc_ns_sum;     /*!< Host time spent in the pipeline per sample */
+    double proc_ns_max;
+    double stale_ms_sum;    /*!< Age of the trace record used for a sample */
+    double stale_ms_max;
+    unsigned long queued;   /*!< QoS > 0 messages passed through the outbox */
+    double queue_ms_sum;    /*!< Time a message waits in the simulated outbox */
+    double queue_ms_max;
+    uint32_t backlog_max;
+} replay_stats_t;
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Parse one trace line; returns 0 for lines that do not carry a record
+static int parse_line(const char *line, trace_rec_t *rec) {
+    unsigned long ms;
+    unsigned st, srh;
+    const char *p = strstr(line, "raw ");
+
+    if (line[0] == '#') return 0;
+    p = p ? p + 4 : line;
+    if (sscanf(p, "%lu %x %x", &ms, &st, &srh) != 3 || st > 0xFFFF || srh > 0xFFFF) {
+        return 0;
+    }
+    rec->ms = (uint32_t)ms;
+    rec->st = (uint16_t)st;
+    rec->srh = (uint16_t)srh;
+    return 1;
+}
+
+// Load whole trace; records must be ordered by time
+static int trace_load(trace_t *tr, const char *path) {
+    FILE *f = strcmp(path, "-") ? fopen(path, "r") : stdin;
+    char line[256];
+    trace_rec_t rec;
+
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+    while (fgets(line, sizeof(line), f)) {
+        if (!parse_line(line, &rec)) continue;
+        if (tr->count && rec.ms < tr->recs[tr->count - 1].ms) {
+            fprintf(stderr, "%s: record at %lu ms out of order, skipped\n", path, (unsigned long)rec.ms);
+            continue;
+        }
+        if (tr->count == tr->cap) {
+            tr->cap = tr->cap ? tr->cap * 2 : 4096;
+            tr->recs = realloc(tr->recs, tr->cap * sizeof(*tr->recs));
+            if (!tr->recs) {
+                perror("realloc");
+                return -1;
+            }
+        }
+        tr->recs[tr->count++] = rec;
+    }
+    if (f != stdin) fclose(f);
+    return 0;
+}
+
+// Replay source standing in for sensor_read: last record at or before virtual time
+static const trace_rec_t *trace_at(const trace_t *tr, size_t *pos, uint32_t now_ms) {
+    while (*pos + 1 < tr->count && tr->recs[*pos + 1].ms <= now_ms) {
+        (*pos)++;
+    }
+    return &tr->recs[*pos];
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+        "usage: %s [options] TRACE|-\n"
+        "  -o FILE|-          write published messages (\"ms topic qos retain payload\")\n"
+        "  --min-ms N         fastest sample interval (%d)\n"
+        "  --max-ms N         slowest sample interval (%d)\n"
+        "  --rate-t X         temperature rate per minute for fastest interval (%.2f)\n"
+        "  --rate-h X         humidity rate per minute for fastest interval (%.2f)\n"
+        "  --backlog N        outbox bytes which slow sampling down (%d)\n"
+        "  --slow-ms N        aggregate period (%d)\n"
+        "  --uplink-bps N     outbox (QoS > 0) drain rate in bytes/s (0 = unlimited)\n"
+        "  --topic BASE       base topic (meteostanice/replay)\n",
+        prog, CONFIG_SAMPLE_MIN_MS, CONFIG_SAMPLE_MAX_MS, CONFIG_SAMPLE_RATE_T,
+        CONFIG_SAMPLE_RATE_H, CONFIG_SAMPLE_BACKLOG_HIGH, CONFIG_MQTT_SLOW_PERIOD_MS);
+    exit(2);
+}
+
+int main(int argc, char **argv) {
+    sampler_limits_t limits = SAMPLER_LIMITS_DEFAULT;
+    uint32_t slow_ms = CONFIG_MQTT_SLOW_PERIOD_MS;
+    double uplink_bps = 0;
+    const char *topic = "meteostanice/replay";
+    const char *trace_path = NULL;
+    const char *out_path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        const char *v = i + 1 < argc ? argv[i + 1] : NULL;
+        if (a[0] != '-' || !strcmp(a, "-")) {
+            trace_path = a;
+            continue;
+        }
+        if (!v) usage(argv[0]);
+        if (!strcmp(a, "-o")) out_path = v;
+        else if (!strcmp(a, "--min-ms")) limits.min_ms = strtoul(v, NULL, 10);
+        else if (!strcmp(a, "--max-ms")) limits.max_ms = strtoul(v, NULL, 10);
+        else if (!strcmp(a, "--rate-t")) limits.rate_t = strtof(v, NULL);
+        else if (!strcmp(a, "--rate-h")) limits.rate_h = strtof(v, NULL);
+        else if (!strcmp(a, "--backlog")) limits.backlog_high = strtoul(v, NULL, 10);
+        else if (!strcmp(a, "--slow-ms")) slow_ms = strtoul(v, NULL, 10);
+        else if (!strcmp(a, "--uplink-bps")) uplink_bps = strtod(v, NULL);
+        else if (!strcmp(a, "--topic")) topic = v;
+        else usage(argv[0]);
+        i++;
+    }
+    if (!trace_path) usage(argv[0]);
+
+    trace_t tr = {0};
+    if (trace_load(&tr, trace_path) != 0) return 1;
+    if (tr.count == 0) {
+        fprintf(stderr, "%s: no records\n", trace_path);
+        return 1;
+    }
+
+    FILE *out = NULL;
+    if (out_path) {
+        out = strcmp(out_path, "-") ? fopen(out_path, "w") : stdout;
+        if (!out) {
+            perror(out_path);
+            return 1;
+        }
+    }
+
+    const uint32_t start_ms = tr.recs[0].ms;
+    const uint32_t end_ms = tr.recs[tr.count - 1].ms;
+    sampler_t sampler;
+    telemetry_t telemetry;
+    static telemetry_msg_t msgs[TELEMETRY_MAX_MSGS];
+    replay_stats_t st = {0};
+    double backlog = 0;
+    size_t pos = 0;
+
+    sampler_init(&sampler, &limits);
+    telemetry_init(&telemetry, topic, slow_ms, start_ms);
+
+    const double wall_start = now_ns();
+    for (uint32_t now = start_ms; ; ) {
+        const trace_rec_t *rec = trace_at(&tr, &pos, now);
+        float temp, hum;
+
+        const double t0 = now_ns();
+        sensor_convert(rec->st, rec->srh, &temp, &hum);
+        uint32_t interval = sampler_next_interval(&sampler, temp, hum, now, (uint32_t)backlog);
+        int n = telemetry_on_sample(&telemetry, temp, hum, interval, now, msgs, TELEMETRY_MAX_MSGS);
+        const double took = now_ns() - t0;
+
+        st.samples++;
+        st.proc_ns_sum += took;
+        if (took > st.proc_ns_max) st.proc_ns_max = took;
+        const double stale = now - rec->ms;
+        st.stale_ms_sum += stale;
+        if (stale > st.stale_ms_max) st.stale_ms_max = stale;
+
+        for (int i = 0; i < n; i++) {
+            size_t len = strlen(msgs[i].topic) + strlen(msgs[i].payload) + MQTT_PUBLISH_OVERHEAD
+                       + (msgs[i].qos > 0 ? MQTT_PACKET_ID_LEN : 0);
+            st.messages++;
+            st.bytes_out += len;
+            if (msgs[i].qos > 0) {
+                // Message leaves once everything queued before it is drained
+                backlog += len;
+                const double queued = uplink_bps > 0 ? backlog * 1000.0 / uplink_bps : 0;
+                st.queued++;
+                st.queue_ms_sum += queued;
+                if (queued > st.queue_ms_max) st.queue_ms_max = queued;
+            }
+            if (out) {
+                fprintf(out, "%lu %s %d %d %s\n", (unsigned long)now, msgs[i].topic,
+                        msgs[i].qos, msgs[i].retain, msgs[i].payload);
+            }
+        }
+        if (backlog > st.backlog_max) st.backlog_max = (uint32_t)backlog;
+
+        if (interval == 0 || end_ms - now < interval) break;
+        now += interval;
+        backlog = uplink_bps > 0 ? backlog - uplink_bps * interval / 1000.0 : 0;
+        if (backlog < 0) backlog = 0;
+    }
+    const double wall_s = (now_ns() - wall_start) / 1e9;
+
+    if (out && out != stdout) fclose(out);
+
+    const double virt_s = (end_ms - start_ms) / 1000.0;
+    FILE *rep = out == stdout ? stderr : stdout;
+    fprintf(rep, "records      %zu over %.1f h\n", tr.count, virt_s / 3600.0);
+    fprintf(rep, "samples      %lu (%.1f per hour)\n", st.samples,
+            virt_s > 0 ? st.samples * 3600.0 / virt_s : 0.0);
+    fprintf(rep, "messages     %lu\n", st.messages);
+    fprintf(rep, "bytes out    %llu (%.1f B/sample, %.1f B/h)\n", st.bytes_out,
+            (double)st.bytes_out / st.samples, virt_s > 0 ? st.bytes_out * 3600.0 / virt_s : 0.0);
+    fprintf(rep, "wall time    %.3f s (speedup %.0fx, %.0f samples/s)\n", wall_s,
+            wall_s > 0 ? virt_s / wall_s : 0.0, wall_s > 0 ? st.samples / wall_s : 0.0);
+    fprintf(rep, "processing   avg %.0f ns, max %.0f ns per sample\n",
+            st.proc_ns_sum / st.samples, st.proc_ns_max);
+    fprintf(rep, "staleness    avg %.0f ms, max %.0f ms\n",
+            st.stale_ms_sum / st.samples, st.stale_ms_max);
+    fprintf(rep, "uplink queue %lu QoS>0 messages, avg %.0f ms, max %.0f ms, backlog max %lu B\n",
+            st.queued, st.queued ? st.queue_ms_sum / st.queued : 0.0, st.queue_ms_max,
+            (unsigned long)st.backlog_max);
+
+    free(tr.recs);
+    return 0;
+}